@@ -9,37 +9,67 @@ CMD_SRCS += \
 ../lnk_msp430g2553.cmd 
 
 C_SRCS += \
+../autopilot.c \
+../autopilot_policy.c \
+../game.c \
 ../graphics.c \
+../level.c \
+../levels.c \
 ../main.c \
 ../rand.c \
 ../sound.c 
 
 C_DEPS += \
+./autopilot.d \
+./autopilot_policy.d \
+./game.d \
 ./graphics.d \
+./level.d \
+./levels.d \
 ./main.d \
 ./rand.d \
 ./sound.d 
 
 OBJS += \
+./autopilot.obj \
+./autopilot_policy.obj \
+./game.obj \
 ./graphics.obj \
+./level.obj \
+./levels.obj \
 ./main.obj \
 ./rand.obj \
 ./sound.obj 
 
 OBJS__QUOTED += \
+"autopilot.obj" \
+"autopilot_policy.obj" \
+"game.obj" \
 "graphics.obj" \
+"level.obj" \
+"levels.obj" \
 "main.obj" \
 "rand.obj" \
 "sound.obj" 
 
 C_DEPS__QUOTED += \
+"autopilot.d" \
+"autopilot_policy.d" \
+"game.d" \
 "graphics.d" \
+"level.d" \
+"levels.d" \
 "main.d" \
 "rand.d" \
 "sound.d" 
 
 C_SRCS__QUOTED += \
+"../autopilot.c" \
+"../autopilot_policy.c" \
+"../game.c" \
 "../graphics.c" \
+"../level.c" \
+"../levels.c" \
 "../main.c" \
 "../rand.c" \
 "../sound.c" 
@@ -0,0 +1,67 @@
+#include <stdint.h>
+
+#include "autopilot.h"
+#include "cycles.h"
+#include "game.h"
+#include "graphics.h"
+
+static const uint8_t kAutopilotRows = 3;
+
+
+/*
+ * Compresses the rows above the player into a policy table index. One pass over the item slots
+ * and constant multiplies (shifts and adds, the G2553 has no multiplier), three bytes of stack.
+ * Counted cost of GetAutopilotButton(), call and return included (see cycles.h):
+ *   fixed 108 to 123 (the policy shift depends on the state), plus per item slot 29 when empty,
+ *   53 when in use, 66 when in rows 4 to 6 but out of reach, 88 when it sets a row state
+ *   worst case: 8 slots in use, 3 of them in row states = 123 + 5 * 53 + 3 * 88 = 652 cycles
+ * That is 0.4% of the 163840 cycle (20 x 8192) turn at 1 MHz. host/autopilot_train.c reports the
+ * counted mean and maximum over its evaluation games.
+ */
+extern uint16_t GetAutopilotState() {
+    const uint8_t player_x_coordinate = GetPlayerXCoordinate();
+    uint8_t row_states[3] = {0, 0, 0}; // rows 6, 5 and 4
+    COUNT_CYCLES(42);   // call, 4 saves, GetPlayerXCoordinate() call, clear row states, loop setup
+
+    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
+        COUNT_CYCLES(29);   // IsItemUnallocated() call, test, loop increment and branch
+        if (IsItemUnallocated(item_index)) {
+            continue;
+        }
+
+        const struct Item *item = GetItem(item_index);
+        const uint8_t row = (uint8_t)(kScreenMaxCoordinate - 1 - item->y_coordinate); // wraps for the player row
+        COUNT_CYCLES(24);   // GetItem() call, row and range check
+        if (row >= kAutopilotRows) {
+            continue;
+        }
+
+        // The player can move one column per turn before the item lands
+        const int8_t radius = row + 1;
+        const int8_t offset = (int8_t)item->x_coordinate - (int8_t)player_x_coordinate;
+        COUNT_CYCLES(13);   // offset with sign extension, two compares against the radius
+        if (offset < -radius || offset > radius) {
+            continue;
+        }
+
+        row_states[row] = 1 + ((offset + radius) << 1) + (kItemTypes[item->type].turn_delta < 0);
+        COUNT_CYCLES(22);   // descriptor lookup, sign test, indexed store
+    }
+
+    uint8_t wall_state = 0;
+    if (player_x_coordinate == 0) {
+        wall_state = 1;
+    } else if (player_x_coordinate == kScreenMaxCoordinate) {
+        wall_state = 2;
+    }
+
+    COUNT_CYCLES(46);   // wall compares, three loads, x11 / x7 / x15 as shifts and adds, restore, ret
+    return row_states[0] + kAutopilotRow6States * (row_states[1] + kAutopilotRow5States * (row_states[2] + kAutopilotRow4States * (uint16_t)wall_state));
+}
+
+// Each policy byte holds the buttons for four consecutive states, lowest state in the low bits
+extern enum Button GetAutopilotButton() {
+    const uint16_t state = GetAutopilotState();
+    COUNT_CYCLES(20 + 5 * (state & 0x03));  // call, byte index, table load, 2 bit steps of the shift, ret
+    return (enum Button)((kAutopilotPolicy[state >> 2] >> ((state & 0x03) << 1)) & 0x03);
+}
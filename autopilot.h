@@ -0,0 +1,29 @@
+#ifndef AUTOPILOT_H_
+#define AUTOPILOT_H_
+
+#include <stdint.h>
+
+#include "game.h"
+
+/*
+ * The autopilot looks at the three rows directly above the player. Only one item can ever be in
+ * a row (one item spawns per turn at most), so each row compresses to "empty" or whether the
+ * item helps or hurts plus its column offset from the player, clipped to how far the player
+ * could move before the item lands. One more digit records whether the player is against a wall.
+ */
+enum {
+    kAutopilotRow6States = 1 + 2 * 3,   // empty, or good/bad item at offset -1..1
+    kAutopilotRow5States = 1 + 2 * 5,   // empty, or good/bad item at offset -2..2
+    kAutopilotRow4States = 1 + 2 * 7,   // empty, or good/bad item at offset -3..3
+    kAutopilotWallStates = 3,           // no wall, wall at x == 0, wall at x == max
+    kAutopilotStateCount = kAutopilotRow6States * kAutopilotRow5States * kAutopilotRow4States * kAutopilotWallStates,
+    kAutopilotPolicyBytes = (kAutopilotStateCount + 3) / 4 // four 2 bit buttons per byte
+};
+
+// Policy table trained on the host by host/autopilot_train.c, generated into autopilot_policy.c
+extern const uint8_t kAutopilotPolicy[kAutopilotPolicyBytes];
+
+extern uint16_t GetAutopilotState();
+extern enum Button GetAutopilotButton();
+
+#endif /* AUTOPILOT_H_ */
@@ -0,0 +1,27 @@
+#ifndef CYCLES_H_
+#define CYCLES_H_
+
+#include "msp430g2553.h"
+
+/*
+ * COUNT_CYCLES(n) sits next to the code it describes and gives its MSP430 cost, counted from the
+ * instruction timings of the optimized (Release) build: 1 cycle register to register, 2 for an
+ * @Rn or immediate source, 3 for an indexed or absolute source, 4 more for an indexed or absolute
+ * destination, 2 per jump, 5 per call, 3 per ret and push, 2 per pop.
+ *
+ * Host builds add the counts up in host_cycles, so host tools report the cost of whatever path
+ * the code really took. Firmware builds compile them away.
+ *
+ * The counts are by hand for the project's cl430 18.1.4.LTS Release settings; they were not read
+ * off its --asm_listing output and nothing checks them against it. Every figure a host tool
+ * prints is a sum of these constants, so recount the annotations from the listing whenever the
+ * code around them or the compiler changes.
+ */
+#ifdef HOST_BUILD
+extern unsigned long host_cycles;
+#define COUNT_CYCLES(cycles) (host_cycles += (cycles))
+#else
+#define COUNT_CYCLES(cycles)
+#endif
+
+#endif /* CYCLES_H_ */
@@ -0,0 +1,228 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "graphics.h"
+#include "level.h"
+#include "rand.h"
+
+// Constants
+const uint8_t kTurnsWinThreshold = 100; // number of remaining turns needed to win
+static const uint8_t kItemGenerationPeriod = 2;
+
+const struct ItemTypeDescriptor kItemTypes[kItemTypeCount] = {
+    [kUnallocatedItem] = {kBlack, 0, 0, 0},
+    [kCoin] = {kYellow, 4, 1, 20},
+    [kBomb] = {kRed, 4, 1, -20}
+};
+
+
+static struct Item items[kMaxItems];
+
+static unsigned int player_x_coordinate = 0;                    // starts player at (0,7)
+static int remaining_turns = kTurnsWinThreshold / 2;       // initializes remaining turns to the max
+
+static uint8_t item_generation_delay = 0;
+static uint8_t selected_level = kRandomLevel;
+
+static uint8_t item_spawn_table[8];     // item type for each rand8() draw, filled from the spawn weights
+
+
+
+extern const struct Item *GetItem(const uint8_t item_index) {
+    return &items[item_index];
+}
+
+extern bool IsItemUnallocated(const uint8_t item_index) {
+    return items[item_index].type == kUnallocatedItem;
+}
+
+extern uint8_t GetPlayerXCoordinate() {
+    return player_x_coordinate;
+}
+
+extern int GetRemainingTurns() {
+    return remaining_turns;
+}
+
+
+extern void UpdatePlayerPosition(const enum Button button) {
+    /*
+     * Updates player position
+     */
+    switch (button) {
+        case kLeftButton: {
+            if (player_x_coordinate < kScreenMaxCoordinate) {
+                // If player is not on the right side of the screen
+                ++player_x_coordinate;
+            }
+            break;
+        }
+
+        case kRightButton: {
+            if (player_x_coordinate > 0) {
+                // If player is on the left side of screen
+                --player_x_coordinate;
+            }
+            break;
+        }
+    }
+}
+
+
+static int GetFreeItemIndex() {
+    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
+        if (IsItemUnallocated(item_index)) {
+            return item_index;
+        }
+    }
+
+    return -1;
+}
+
+// Gives every item type spawn_weight of the 8 rand8() draws, in kItemTypes order. Draws left
+// over when the weights add up to less than 8 spawn nothing.
+static void FillSpawnTable() {
+    uint8_t slot = 0;
+    for (uint8_t type = 0; type < kItemTypeCount; ++type) {
+        for (uint8_t i = 0; i < kItemTypes[type].spawn_weight && slot < sizeof(item_spawn_table); ++i) {
+            item_spawn_table[slot++] = type;
+        }
+    }
+
+    while (slot < sizeof(item_spawn_table)) {
+        item_spawn_table[slot++] = kUnallocatedItem;
+    }
+}
+
+// picks an item type with the odds given by the spawn weights
+static enum ItemType GenerateRandomItemType() {
+    return (enum ItemType)item_spawn_table[rand8()];
+}
+
+static bool CreateRandomItem() {
+    const int item_index = GetFreeItemIndex();
+    if (item_index >= 0) {
+        items[item_index].type = GenerateRandomItemType();
+        items[item_index].x_coordinate = rand8();
+        items[item_index].y_coordinate = 0;
+        return true;
+    }
+
+    return false;
+}
+
+static bool CreateLevelItem() {
+    uint8_t x_coordinate;
+    const enum ItemType type = DecodeLevelRow(&x_coordinate);
+    const int item_index = GetFreeItemIndex();
+    if (type != kUnallocatedItem && item_index >= 0) {
+        items[item_index].type = type;
+        items[item_index].x_coordinate = x_coordinate;
+        items[item_index].y_coordinate = 0;
+        return true;
+    }
+
+    return false;
+}
+
+extern void HandleItemGeneration() {
+    // authored levels decide every row themselves
+    if (selected_level != kRandomLevel) {
+        CreateLevelItem();
+        return;
+    }
+
+    //generates new item at a set rate
+    if (item_generation_delay >= kItemGenerationPeriod) {
+        CreateRandomItem();
+        item_generation_delay = 0;
+    } else {
+        ++item_generation_delay;
+    }
+}
+
+static bool IsItemOffscreen(const uint8_t item_index) {
+    return items[item_index].y_coordinate > kScreenMaxCoordinate;
+}
+
+static void MoveItemDown(const uint8_t item_index) {
+    const uint8_t y_coordinate = items[item_index].y_coordinate;
+    const uint8_t next_y_coordinate = y_coordinate + kItemTypes[items[item_index].type].fall_rate;
+
+    // Fast items still land on the player row before leaving the screen
+    if (y_coordinate < kScreenMaxCoordinate && next_y_coordinate > kScreenMaxCoordinate) {
+        items[item_index].y_coordinate = kScreenMaxCoordinate;
+    } else {
+        items[item_index].y_coordinate = next_y_coordinate;
+    }
+}
+
+
+static void RemoveItem(const uint8_t item_index) {
+    items[item_index].type = kUnallocatedItem;
+}
+
+static bool IsItemOverlappingPlayer(const uint8_t item_index) {
+    return items[item_index].y_coordinate == kScreenMaxCoordinate && items[item_index].x_coordinate == player_x_coordinate;
+}
+
+
+static void UpdateItemPosition(const uint8_t item_index) {
+    MoveItemDown(item_index);
+
+    if (IsItemOffscreen(item_index)) {
+        RemoveItem(item_index);
+    } else if (IsItemOverlappingPlayer(item_index)) {
+        remaining_turns += kItemTypes[items[item_index].type].turn_delta;
+    }
+}
+
+
+extern void UpdateItemsPosition() {
+    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
+        if (!IsItemUnallocated(item_index)) {
+            UpdateItemPosition(item_index);
+        }
+    }
+}
+
+extern void ConsumeTurn() {
+    --remaining_turns;
+}
+
+extern bool IsGameWon() {
+    return remaining_turns >= kTurnsWinThreshold;
+}
+
+extern bool IsGameLost() {
+    return remaining_turns <= 0;
+}
+
+extern void ResetGameState() {
+    for (uint8_t i = 0; i < kMaxItems; ++i) {
+        items[i].type = kUnallocatedItem;
+    }
+
+    player_x_coordinate = 0;
+    remaining_turns = kTurnsWinThreshold / 2;
+    item_generation_delay = 0;
+
+    if (selected_level == kRandomLevel) {
+        FillSpawnTable();
+    } else {
+        StartLevelStream(&kLevelStreams[kLevelOffsets[selected_level]]);
+    }
+}
+
+// takes effect with the next ResetGameState()
+extern void SelectLevel(const uint8_t level) {
+    selected_level = level;
+}
+
+// after a win, authored levels move on to the next one and wrap around
+extern void AdvanceLevel() {
+    if (selected_level != kRandomLevel) {
+        selected_level = (selected_level + 1) % kLevelCount;
+    }
+}
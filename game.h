@@ -0,0 +1,59 @@
+#ifndef GAME_H_
+#define GAME_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+// Constants
+enum { kMaxItems = 8 }; // max number of items, enum so it can size arrays on every compiler
+extern const uint8_t kTurnsWinThreshold;
+
+enum ItemType {
+    kUnallocatedItem,
+    kCoin,
+    kBomb,
+    kItemTypeCount
+};
+
+// Everything that differs between item types, indexed by enum ItemType
+struct ItemTypeDescriptor {
+    enum Color color;
+    uint8_t spawn_weight;   // rand8() draws out of 8 that spawn this type in random games
+    uint8_t fall_rate;      // rows moved per turn
+    int8_t turn_delta;      // change to the remaining turns when the player catches it
+};
+
+extern const struct ItemTypeDescriptor kItemTypes[kItemTypeCount];
+
+enum Button {
+    kNoButton,
+    kLeftButton,
+    kRightButton
+};
+
+struct Item {
+    enum ItemType type;
+    uint8_t x_coordinate;
+    uint8_t y_coordinate;
+}__attribute__((packed));
+
+
+extern void ResetGameState();
+extern void UpdateItemsPosition();
+extern void HandleItemGeneration();
+extern void UpdatePlayerPosition(const enum Button button);
+extern void ConsumeTurn();
+extern void SelectLevel(const uint8_t level);   // level index, or kRandomLevel from level.h
+extern void AdvanceLevel();
+
+extern bool IsGameWon();
+extern bool IsGameLost();
+
+extern const struct Item *GetItem(const uint8_t item_index);
+extern bool IsItemUnallocated(const uint8_t item_index);
+extern uint8_t GetPlayerXCoordinate();
+extern int GetRemainingTurns();
+
+#endif /* GAME_H_ */
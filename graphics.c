@@ -3,6 +3,7 @@
 
 #include "msp430g2553.h"
 
+#include "cycles.h"
 #include "graphics.h"
 
 const uint8_t kScreenMaxCoordinate = 7;
@@ -10,33 +11,104 @@ const uint8_t kScreenMaxCoordinate = 7;
 static const uint8_t kLedBrightness = 0xE1;
 
 
+#ifdef PACKED_FRAMEBUFFER
+/*
+ * Screen LEDs hold 4 bit palette indices, two per byte with the lower LED in the low nibble.
+ * The palette keeps the game colors exact and samples the animation ramp every 17 steps.
+ */
+static const uint8_t kPaletteColors[16] = {
+    kBlack, kBlue, 17, 34, 51, 68, 85, 102, kGreen, 145, 162, 179, kYellow, 213, 230, kRed
+};
+
+// b_val, g_val and r_val of each palette color, in wire order
+static const uint8_t kPaletteBgr[16][3] = {
+    {0, 0, 0},   {252, 2, 0},  {220, 34, 0}, {186, 68, 0}, {152, 102, 0}, {118, 136, 0}, {84, 170, 0}, {50, 204, 0},
+    {0, 254, 0}, {0, 220, 34}, {0, 186, 68}, {0, 152, 102}, {0, 118, 136}, {0, 84, 170}, {0, 50, 204}, {0, 0, 254}
+};
+
+// Palette index of the largest palette color <= color & 0xF0, by the high nibble of color
+static const uint8_t kPaletteBuckets[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 10, 11, 12, 13, 14};
+
+static uint8_t status_palette_index;
+static uint8_t led_palette_indices[32];
+#else
 //static enum Color led_colors[(kScreenMaxCoordinate + 1) * (kScreenMaxCoordinate + 1) + 1];
 static enum Color led_colors[65];
+#endif
+
+#ifdef HOST_BUILD
+// Frame buffer RAM for host/framebuffer_bench.c, not part of the firmware image
+#ifdef PACKED_FRAMEBUFFER
+const uint16_t kFrameBufferSize = sizeof(status_palette_index) + sizeof(led_palette_indices);
+#else
+const uint16_t kFrameBufferSize = sizeof(led_colors);
+#endif
+#endif
+
+
+#ifdef PACKED_FRAMEBUFFER
+// Rounds down to the nearest palette color. Palette colors are at least 16 apart past kBlue, so
+// the bucket is off by at most one entry.
+static uint8_t GetPaletteIndex(const enum Color color) {
+    COUNT_CYCLES(27);   // call, high nibble shifts, bucket load, bound check, next color compare, ret
+    uint8_t palette_index = kPaletteBuckets[(uint8_t)color >> 4];
+    if (palette_index < 15 && kPaletteColors[palette_index + 1] <= (uint8_t)color) {
+        COUNT_CYCLES(1);
+        ++palette_index;
+    }
 
-
+    return palette_index;
+}
+#endif
 
 extern void EraseLedBuffer() {
-    led_colors[0] = kBlack;
+    COUNT_CYCLES(10);   // call, two arguments, ret
+    SetStatusLedColor(kBlack);
     SetScreenSolidColor(kBlack);
 }
 
 
 extern void SetScreenBufferColor(const uint8_t x_coordinate, const uint8_t y_coordinate, const enum Color color) {
+#ifdef PACKED_FRAMEBUFFER
+    // call with three arguments, two saves, LED index, pair address, odd test, two restores, ret
+    COUNT_CYCLES(35);
+    const uint8_t led_index = y_coordinate * (kScreenMaxCoordinate + 1) + (kScreenMaxCoordinate - x_coordinate);
+    uint8_t *const led_pair = &led_palette_indices[led_index >> 1];
+    if (led_index & 1) {
+        COUNT_CYCLES(13);   // pair load, mask, 4 shifts, merge, store
+        *led_pair = (*led_pair & 0x0F) | (GetPaletteIndex(color) << 4);
+    } else {
+        COUNT_CYCLES(9);    // pair load, mask, merge, store
+        *led_pair = (*led_pair & 0xF0) | GetPaletteIndex(color);
+    }
+#else
+    COUNT_CYCLES(22);   // call with three arguments, y * 8 + 7 - x + 1, indexed store, ret
     led_colors[y_coordinate * (kScreenMaxCoordinate + 1) + (kScreenMaxCoordinate - x_coordinate) + 1] = color;
+#endif
 }
 
 extern void SetStatusLedColor(const enum Color color) {
+#ifdef PACKED_FRAMEBUFFER
+    COUNT_CYCLES(13);   // call with argument, absolute store, ret
+    status_palette_index = GetPaletteIndex(color);
+#else
+    COUNT_CYCLES(13);
     led_colors[0] = color;
+#endif
 }
 
 
+#ifndef PACKED_FRAMEBUFFER
 // Linearly increases red intensity over second half of range, zero otherwise
 static uint8_t r_val(const uint8_t temp) {
     if (temp == 0) {
+        COUNT_CYCLES(12);       // call, test, branch, clear, ret
         return 0;
     } else if (temp < 128) {
+        COUNT_CYCLES(16);
         return 0;               // Returns 0 red value for first half of range
     } else {
+        COUNT_CYCLES(18);
         return (temp - 128) << 1; // Multiply by 2 and prevent overflow using left shift
     }
 }
@@ -44,10 +116,13 @@ static uint8_t r_val(const uint8_t temp) {
 // Linearly increases green intensity over first half of range and linearly decreases green intensity for second half of range
 static uint8_t g_val(const uint8_t temp) {
     if (temp == 0) {
+        COUNT_CYCLES(12);
         return 0;
     } else if (temp < 128) {
+        COUNT_CYCLES(16);
         return temp << 1;         // Multiply by 2 and prevent overflow using left shift
     } else {
+        COUNT_CYCLES(20);
         return (255 - temp) << 1; // Multiply by 2 and prevent overflow using left shift
     }
 }
@@ -55,13 +130,17 @@ static uint8_t g_val(const uint8_t temp) {
 // Linearly decreases blue intensity over first half of range, zero otherwise
 static uint8_t b_val(const uint8_t temp) {
     if (temp == 0) {
+        COUNT_CYCLES(12);
         return 0;
     } else if (temp < 128) {
+        COUNT_CYCLES(20);
         return (127 - temp) << 1; // Multiply by 2 and prevent overflow using left shift
     } else {
+        COUNT_CYCLES(16);
         return 0;                   // Returns 0 blue value for second half of range
     }
 }
+#endif
 
 
 // initializes SPI communication to LEDs
@@ -79,6 +158,8 @@ extern void InitializeGraphics() {
 }
 
 extern void SendSpiByte(const uint8_t byte) {
+    // call, three register writes, sleep, TX interrupt entry, ISR body and reti, disable, ret
+    COUNT_CYCLES(46);
     UCA0TXBUF = byte;
     IFG2 |= UCA0TXIFG;         // Tells USCI to trigger transfer into the buffer
     IE2 |= UCA0TXIE;
@@ -87,13 +168,38 @@ extern void SendSpiByte(const uint8_t byte) {
 }
 
 
+#ifdef PACKED_FRAMEBUFFER
+static void SendPaletteLed(const uint8_t palette_index) {
+    const uint8_t *const bgr = kPaletteBgr[palette_index];
+    COUNT_CYCLES(29);   // call, push, index x3 and table address, brightness, three loads, pop, ret
+
+    SendSpiByte(kLedBrightness);
+
+    SendSpiByte(bgr[0]);
+    SendSpiByte(bgr[1]);
+    SendSpiByte(bgr[2]);
+}
+#endif
+
 extern void SendFrameBuffer() {
     // Send first frame (4 bytes of all 0s)
     for (uint8_t i = 0; i < 4; ++i) {
+        COUNT_CYCLES(6);    // argument, loop increment and branch
         SendSpiByte(0x00);
     }
 
+#ifdef PACKED_FRAMEBUFFER
+    COUNT_CYCLES(3);
+    SendPaletteLed(status_palette_index);
+
+    for (uint8_t i = 0; i < sizeof(led_palette_indices); ++i) {
+        COUNT_CYCLES(17);   // two loads, low nibble mask, high nibble 4 shifts, loop
+        SendPaletteLed(led_palette_indices[i] & 0x0F);
+        SendPaletteLed(led_palette_indices[i] >> 4);
+    }
+#else
     for (uint8_t i = 0; i < 65; ++i) {
+        COUNT_CYCLES(13);   // color load, brightness, three result moves, loop
         SendSpiByte(kLedBrightness);
 
         SendSpiByte(b_val(led_colors[i]));
@@ -103,12 +209,22 @@ extern void SendFrameBuffer() {
 
 
     }
+#endif
 
     for (uint8_t i = 0; i < 4; ++i) {
+        COUNT_CYCLES(6);
         SendSpiByte(0xFF);
     }
 }
 
 extern void SetScreenSolidColor(enum Color color) {
+// memset() stores one byte per 8 cycle loop
+#ifdef PACKED_FRAMEBUFFER
+    COUNT_CYCLES(42 + 8 * 32);  // call, save, nibble pair, memset() call and setup, restore, ret
+    const uint8_t palette_index = GetPaletteIndex(color);
+    memset(led_palette_indices, palette_index | (palette_index << 4), sizeof(led_palette_indices));
+#else
+    COUNT_CYCLES(30 + 8 * 64);  // call, memset() call and setup, ret
     memset(led_colors + 1, color, 64);
+#endif
 }
@@ -6,6 +6,9 @@
 
 extern const uint8_t kScreenMaxCoordinate;
 
+// Define PACKED_FRAMEBUFFER to store 4 bit palette indices instead of one color byte per LED,
+// at the cost of quantizing the animation ramp.
+
 enum Color {
     kBlack = 0,
     kBlue = 1,
@@ -0,0 +1,212 @@
+/*
+ * Trains the attract mode autopilot policy against the real game rules and writes it out as a
+ * flash table for the firmware.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o autopilot_train host/autopilot_train.c \
+ *       host/msp430_host.c host/simulation.c game.c level.c levels.c autopilot.c autopilot_policy.c \
+ *       graphics.c rand.c
+ *   ./autopilot_train [training games] [output file]
+ *
+ * Training is tabular Q-learning over the autopilot's compressed board view. The reward is the
+ * change in remaining turns between decisions plus a bonus for winning or losing. Both the table
+ * that is compiled in right now and the freshly trained one are evaluated on the same seeds.
+ *
+ * Training is deterministic: fixed seeds, and Q-values in integer fixed point so no compiler or
+ * floating point unit can change a single update. autopilot_policy.c is the output of the
+ * default run, and the tool says whether the table it trained matches the compiled one.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "autopilot.h"
+#include "cycles.h"
+#include "game.h"
+#include "simulation.h"
+
+static const unsigned long kDefaultTrainingGames = 300000;
+static const unsigned long kEvaluationGames = 20000;
+static const unsigned long kMaxGameTurns = 5000;      // games that neither win nor lose count as losses
+static const int32_t kValueScale = 256;               // Q-values are in 1/256 turns
+static const int32_t kLearningRateDivisor = 20;       // learning rate 1/20
+static const int32_t kDiscountPercent = 97;
+static const int32_t kTerminalReward = 100;
+static const uint32_t kStartExplorationPpm = 200000;  // share of random moves in parts per million
+static const uint32_t kEndExplorationPpm = 10000;
+
+static int32_t q_values[kAutopilotStateCount][3];
+static uint8_t trained_policy[kAutopilotPolicyBytes];
+static uint32_t explore_state = 0x2545F491u;
+
+
+static uint32_t NextExploreRandom() {
+    // xorshift32, kept separate from the game LFSR so exploration does not change the games
+    explore_state ^= explore_state << 13;
+    explore_state ^= explore_state >> 17;
+    explore_state ^= explore_state << 5;
+    return explore_state;
+}
+
+static enum Button GetBestButton(const uint16_t state) {
+    enum Button best = kNoButton;
+    for (uint8_t button = kLeftButton; button <= kRightButton; ++button) {
+        if (q_values[state][button] > q_values[state][best]) {
+            best = (enum Button)button;
+        }
+    }
+
+    return best;
+}
+
+static int32_t GetBestValue(const uint16_t state) {
+    return q_values[state][GetBestButton(state)];
+}
+
+static void TrainGame(const uint16_t seed, const uint32_t exploration_ppm) {
+    StartGame(seed);
+    if (!BeginTurn()) {
+        return;
+    }
+
+    uint16_t state = GetAutopilotState();
+    for (unsigned long turn = 0; turn < kMaxGameTurns; ++turn) {
+        enum Button button = GetBestButton(state);
+        if (NextExploreRandom() % 1000000 < exploration_ppm) {
+            button = (enum Button)(NextExploreRandom() % 3);
+        }
+
+        const int remaining_turns = GetRemainingTurns();
+        const enum Outcome outcome = EndTurn(button);
+
+        int32_t target;
+        uint16_t next_state = state;
+        bool is_game_over = true;
+        if (outcome == kWon) {
+            target = kTerminalReward * kValueScale;
+        } else if (outcome == kLost || !BeginTurn()) {
+            target = -kTerminalReward * kValueScale;
+        } else {
+            next_state = GetAutopilotState();
+            target = (GetRemainingTurns() - remaining_turns) * kValueScale + GetBestValue(next_state) * kDiscountPercent / 100;
+            is_game_over = false;
+        }
+
+        q_values[state][button] += (target - q_values[state][button]) / kLearningRateDivisor;
+        if (is_game_over) {
+            return;
+        }
+
+        state = next_state;
+    }
+}
+
+static void PackTrainedPolicy() {
+    memset(trained_policy, 0, sizeof(trained_policy));
+    for (uint16_t state = 0; state < kAutopilotStateCount; ++state) {
+        trained_policy[state >> 2] |= GetBestButton(state) << ((state & 0x03) << 1);
+    }
+}
+
+static enum Button GetTrainedButton() {
+    const uint16_t state = GetAutopilotState();
+    return (enum Button)((trained_policy[state >> 2] >> ((state & 0x03) << 1)) & 0x03);
+}
+
+// Plays greedy games on fixed seeds, returns the win rate and the average game length
+static double EvaluatePolicy(enum Button (*get_button)(), double *average_turns, double *average_cycles, unsigned long *max_cycles) {
+    unsigned long wins = 0;
+    unsigned long total_turns = 0;
+    unsigned long decisions = 0;
+    unsigned long total_cycles = 0;
+    *max_cycles = 0;
+
+    for (unsigned long game = 0; game < kEvaluationGames; ++game) {
+        StartGame((uint16_t)(0x8000u + game));
+
+        for (unsigned long turn = 0; turn < kMaxGameTurns; ++turn) {
+            ++total_turns;
+            if (!BeginTurn()) {
+                break;
+            }
+
+            host_cycles = 0;
+            const enum Button button = get_button();
+            total_cycles += host_cycles;
+            *max_cycles = host_cycles > *max_cycles ? host_cycles : *max_cycles;
+            ++decisions;
+
+            const enum Outcome outcome = EndTurn(button);
+            if (outcome == kWon) {
+                ++wins;
+                break;
+            } else if (outcome == kLost) {
+                break;
+            }
+        }
+    }
+
+    *average_turns = (double)total_turns / kEvaluationGames;
+    *average_cycles = decisions == 0 ? 0 : (double)total_cycles / decisions;
+    return (double)wins / kEvaluationGames;
+}
+
+static enum Button GetIdleButton() {
+    return kNoButton;
+}
+
+static bool WritePolicy(const char *path, const unsigned long training_games) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "/*\n * Attract mode autopilot policy, generated by host/autopilot_train.c from %lu training games.\n", training_games);
+    fprintf(file, " * Do not edit.\n */\n");
+    fprintf(file, "#include <stdint.h>\n\n#include \"autopilot.h\"\n\n");
+    fprintf(file, "const uint8_t kAutopilotPolicy[kAutopilotPolicyBytes] = {");
+    for (uint16_t i = 0; i < kAutopilotPolicyBytes; ++i) {
+        fprintf(file, "%s0x%02X,", i % 12 == 0 ? "\n    " : " ", trained_policy[i]);
+    }
+    fprintf(file, "\n};\n");
+
+    return fclose(file) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long training_games = kDefaultTrainingGames;
+    if (argc > 1 && sscanf(argv[1], "%lu", &training_games) != 1) {
+        fprintf(stderr, "usage: %s [training games] [output file]\n", argv[0]);
+        return 1;
+    }
+    const char *output_path = argc > 2 ? argv[2] : "autopilot_policy.c";
+
+    double average_turns;
+    double average_cycles;
+    unsigned long max_cycles;
+    double win_rate = EvaluatePolicy(GetIdleButton, &average_turns, &average_cycles, &max_cycles);
+    printf("idle player:      win rate %6.2f%%, %.1f turns per game\n", 100.0 * win_rate, average_turns);
+    win_rate = EvaluatePolicy(GetAutopilotButton, &average_turns, &average_cycles, &max_cycles);
+    printf("compiled policy:  win rate %6.2f%%, %.1f turns per game\n", 100.0 * win_rate, average_turns);
+    printf("                  GetAutopilotButton() %.0f counted MSP430 cycles per turn on average, %lu at most\n",
+           average_cycles, max_cycles);
+
+    for (unsigned long game = 0; game < training_games; ++game) {
+        const uint32_t exploration_ppm = kStartExplorationPpm - (uint32_t)((uint64_t)(kStartExplorationPpm - kEndExplorationPpm) * game / training_games);
+        TrainGame((uint16_t)(NextExploreRandom() | 1), exploration_ppm);
+    }
+
+    PackTrainedPolicy();
+    win_rate = EvaluatePolicy(GetTrainedButton, &average_turns, &average_cycles, &max_cycles);
+    printf("trained policy:   win rate %6.2f%%, %.1f turns per game\n", 100.0 * win_rate, average_turns);
+    printf("policy table:     %d states, %d bytes of flash, %s the compiled table\n", kAutopilotStateCount, kAutopilotPolicyBytes,
+           memcmp(trained_policy, kAutopilotPolicy, kAutopilotPolicyBytes) == 0 ? "same as" : "differs from");
+
+    if (!WritePolicy(output_path, training_games)) {
+        fprintf(stderr, "could not write %s\n", output_path);
+        return 1;
+    }
+    printf("wrote %s\n", output_path);
+    return 0;
+}
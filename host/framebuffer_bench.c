@@ -0,0 +1,107 @@
+/*
+ * Compares the byte per LED frame buffer with the PACKED_FRAMEBUFFER palette format.
+ *
+ * Build both variants from the repository root and run them:
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o framebuffer_bench \
+ *       host/framebuffer_bench.c host/msp430_host.c graphics.c
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -DPACKED_FRAMEBUFFER -o framebuffer_bench_packed \
+ *       host/framebuffer_bench.c host/msp430_host.c graphics.c
+ *
+ * The wire checksum of the game frame only uses palette colors, so it has to be the same for
+ * both variants. Costs are the MSP430 cycles counted in graphics.c (see cycles.h) for both halves
+ * of a frame:
+ *   compose   the EraseLedBuffer(), SetScreenBufferColor() and SetStatusLedColor() calls that
+ *             draw it, where the packed format pays for GetPaletteIndex() and the nibble
+ *             read-modify-write
+ *   send      SendFrameBuffer(), split into the SendSpiByte() calls both variants share and the
+ *             per LED expansion around them: the nibble extraction and kPaletteBgr lookup, or the
+ *             r_val/g_val/b_val branches
+ */
+#include <stdint.h>
+#include <stdio.h>
+
+#include "msp430g2553.h"
+
+#include "cycles.h"
+#include "graphics.h"
+
+static const unsigned long kFrames = 20000;
+static const unsigned int kFrameLeds = 65;
+
+extern const uint16_t kFrameBufferSize;     // defined by graphics.c in host builds
+extern void SendSpiByte(const uint8_t byte);
+
+static uint32_t wire_checksum;
+static unsigned long wire_bytes;
+
+
+// SendSpiByte sleeps with the transmit interrupt enabled once per byte
+void HostEnterLowPowerMode(const uint16_t mode) {
+    (void)mode;
+    if (IE2 & UCA0TXIE) {
+        wire_checksum = wire_checksum * 31 + UCA0TXBUF;
+        ++wire_bytes;
+    }
+}
+
+// Roughly what HandleTurn draws: a cleared screen, three items, the player and the status LED
+static void ComposeGameFrame(const unsigned long frame) {
+    EraseLedBuffer();
+    SetScreenBufferColor(frame & 7, 1, kRed);
+    SetScreenBufferColor((frame + 3) & 7, 4, kYellow);
+    SetScreenBufferColor((frame + 5) & 7, 7 - 1, kRed);
+    SetScreenBufferColor(frame & 7, kScreenMaxCoordinate, kGreen);
+    SetStatusLedColor(kYellow);
+}
+
+// What the spiral and win animations draw: one more ramp color per frame
+static void ComposeAnimationFrame(const unsigned long frame) {
+    SetScreenBufferColor((frame >> 3) & 7, frame & 7, (enum Color)(frame & 0xFF));
+}
+
+static void RunBenchmark(const char *name, void (*compose)(const unsigned long), const unsigned long spi_byte_cycles) {
+    unsigned long compose_cycles = 0;
+    unsigned long total_cycles = 0;
+    unsigned long max_cycles = 0;
+
+    wire_checksum = 0;
+    wire_bytes = 0;
+    EraseLedBuffer();
+
+    for (unsigned long frame = 0; frame < kFrames; ++frame) {
+        host_cycles = 0;
+        compose(frame);
+        compose_cycles += host_cycles;
+
+        host_cycles = 0;
+        SendFrameBuffer();
+        total_cycles += host_cycles;
+        max_cycles = host_cycles > max_cycles ? host_cycles : max_cycles;
+    }
+
+    const double frame_cycles = (double)total_cycles / kFrames;
+    const double spi_cycles = (double)wire_bytes / kFrames * spi_byte_cycles;
+    printf("%-10s compose %5.0f cycles/frame, send %7.0f cycles/frame (max %lu), total %7.0f\n", name,
+           (double)compose_cycles / kFrames, frame_cycles, max_cycles, (double)compose_cycles / kFrames + frame_cycles);
+    printf("%-10s send: SendSpiByte %5.0f, expansion %5.1f cycles/LED, %lu wire bytes/frame, checksum %08lX\n", "",
+           spi_cycles, (frame_cycles - spi_cycles) / kFrameLeds, wire_bytes / kFrames, (unsigned long)wire_checksum);
+}
+
+int main() {
+#ifdef PACKED_FRAMEBUFFER
+    printf("packed palette frame buffer: %u bytes of RAM\n", (unsigned int)kFrameBufferSize);
+#else
+    printf("byte per LED frame buffer: %u bytes of RAM\n", (unsigned int)kFrameBufferSize);
+#endif
+
+    InitializeGraphics();
+
+    host_cycles = 0;
+    SendSpiByte(0x00);
+    const unsigned long spi_byte_cycles = host_cycles;
+    wire_checksum = 0;
+
+    RunBenchmark("game", ComposeGameFrame, spi_byte_cycles);
+    RunBenchmark("animation", ComposeAnimationFrame, spi_byte_cycles);
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * Compiles level scripts into the flash stream format described in level.h.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o level_compile host/level_compile.c level.c \
+ *       host/msp430_host.c
+ *   ./level_compile host/levels.txt [levels.c]
+ *
+ * A script is a list of levels, each a list of spawn rows in the order they are played:
+ *   # comment
+ *   level <name>
+ *   ..o.....        one row, drawn like the screen: '.' empty, 'o' coin, 'x' bomb, one item at most
+ *   ........ *12    the same row 12 times
+ *
+ * Every stream is decoded again with the firmware decoder and compared with the script. The
+ * report gives the compression against one byte per row (type and x, as traces store a row) and
+ * the decode cost per turn, in the MSP430 cycles counted in level.c (see cycles.h) along the path
+ * each row really takes.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cycles.h"
+#include "game.h"
+#include "level.h"
+
+enum {
+    kMaxLevels = 32,
+    kMaxLevelRows = 4096,
+    kMaxStreamBytes = 16384,
+    kScreenColumns = 8
+};
+
+_Static_assert(kItemTypeCount <= 4, "item types must fit the 2 bit type field of a level code");
+
+static const char kItemSymbols[kItemTypeCount] = {
+    [kUnallocatedItem] = '.',
+    [kCoin] = 'o',
+    [kBomb] = 'x'
+};
+
+struct LevelRow {
+    enum ItemType type;
+    uint8_t x_coordinate;
+};
+
+struct Level {
+    char name[64];
+    uint16_t row_count;
+    uint16_t offset;            // first code in streams
+    uint16_t byte_count;        // end code included
+};
+
+static struct Level levels[kMaxLevels];
+static struct LevelRow rows[kMaxLevels][kMaxLevelRows];
+static uint8_t streams[kMaxStreamBytes];
+static uint8_t level_count = 0;
+static uint16_t stream_size = 0;
+
+
+static bool ParseRow(const char *text, struct LevelRow *row) {
+    row->type = kUnallocatedItem;
+    row->x_coordinate = 0;
+
+    for (uint8_t column = 0; column < kScreenColumns; ++column) {
+        enum ItemType type = kUnallocatedItem;
+        while (type < kItemTypeCount && kItemSymbols[type] != text[column]) {
+            ++type;
+        }
+
+        if (type == kItemTypeCount || (type != kUnallocatedItem && row->type != kUnallocatedItem)) {
+            return false;
+        } else if (type != kUnallocatedItem) {
+            row->type = type;
+            row->x_coordinate = kScreenColumns - 1 - column;     // x counts up to the left like the LEDs
+        }
+    }
+
+    return text[kScreenColumns] == '\0' || text[kScreenColumns] == ' ' || text[kScreenColumns] == '\t'
+            || text[kScreenColumns] == '\n' || text[kScreenColumns] == '\r';
+}
+
+static bool ParseScript(FILE *script, const char *path) {
+    char line[256];
+    unsigned int line_number = 0;
+
+    while (fgets(line, sizeof(line), script) != NULL) {
+        ++line_number;
+        char *comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        char *text = line + strspn(line, " \t");
+        text[strcspn(text, "\r\n")] = '\0';
+        if (*text == '\0') {
+            continue;
+        }
+
+        if (strncmp(text, "level ", 6) == 0) {
+            if (level_count == kMaxLevels) {
+                fprintf(stderr, "%s:%u: more than %d levels\n", path, line_number, kMaxLevels);
+                return false;
+            }
+            struct Level *level = &levels[level_count++];
+            snprintf(level->name, sizeof(level->name), "%s", text + 6 + strspn(text + 6, " \t"));
+            level->row_count = 0;
+            continue;
+        }
+
+        struct LevelRow row;
+        unsigned int repeat = 1;
+        const char *repeat_text = strchr(text, '*');
+        if (level_count == 0) {
+            fprintf(stderr, "%s:%u: row before the first level line\n", path, line_number);
+            return false;
+        } else if (strlen(text) < kScreenColumns || !ParseRow(text, &row)) {
+            fprintf(stderr, "%s:%u: a row is %d cells of '.', 'o' or 'x' with one item at most\n", path, line_number, kScreenColumns);
+            return false;
+        } else if (repeat_text != NULL && (sscanf(repeat_text + 1, "%u", &repeat) != 1 || repeat == 0)) {
+            fprintf(stderr, "%s:%u: a repeat is written *<count>\n", path, line_number);
+            return false;
+        }
+
+        struct Level *level = &levels[level_count - 1];
+        if (level->row_count + repeat > kMaxLevelRows) {
+            fprintf(stderr, "%s:%u: level %s is longer than %d rows\n", path, line_number, level->name, kMaxLevelRows);
+            return false;
+        }
+        for (unsigned int i = 0; i < repeat; ++i) {
+            rows[level_count - 1][level->row_count++] = row;
+        }
+    }
+
+    if (level_count == 0) {
+        fprintf(stderr, "%s: no levels\n", path);
+        return false;
+    }
+    for (uint8_t i = 0; i < level_count; ++i) {
+        if (levels[i].row_count == 0) {
+            fprintf(stderr, "%s: level %s has no rows\n", path, levels[i].name);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool AppendCode(const uint8_t code) {
+    if (stream_size == kMaxStreamBytes) {
+        fprintf(stderr, "levels need more than %d bytes\n", kMaxStreamBytes);
+        return false;
+    }
+    streams[stream_size++] = code;
+    return true;
+}
+
+// Items take up to kLevelMaxTrailingEmptyRows following empty rows, longer gaps become runs
+static bool EncodeLevel(const uint8_t level_index) {
+    struct Level *level = &levels[level_index];
+    const struct LevelRow *level_rows = rows[level_index];
+    level->offset = stream_size;
+
+    uint16_t row = 0;
+    while (row < level->row_count) {
+        uint16_t empty_rows = 0;
+        uint8_t code = 0;
+
+        if (level_rows[row].type != kUnallocatedItem) {
+            const uint16_t item_row = row++;
+            while (row < level->row_count && empty_rows < kLevelMaxTrailingEmptyRows && level_rows[row].type == kUnallocatedItem) {
+                ++empty_rows;
+                ++row;
+            }
+            code = kLevelItemFlag | (level_rows[item_row].type << 5) | (empty_rows << 3) | level_rows[item_row].x_coordinate;
+        } else {
+            while (row < level->row_count && empty_rows < kLevelMaxEmptyRun && level_rows[row].type == kUnallocatedItem) {
+                ++empty_rows;
+                ++row;
+            }
+            code = (uint8_t)empty_rows;
+        }
+
+        if (!AppendCode(code)) {
+            return false;
+        }
+    }
+
+    if (!AppendCode(kLevelEndCode)) {
+        return false;
+    }
+    level->byte_count = stream_size - level->offset;
+    return true;
+}
+
+// Plays the level twice through the firmware decoder, so the wrap at the end is checked too, and
+// adds up the decode cost of the second pass
+static bool VerifyLevel(const uint8_t level_index, unsigned long *total_cycles, unsigned int *max_cycles) {
+    const struct Level *level = &levels[level_index];
+    const uint8_t *stream = &streams[level->offset];
+    StartLevelStream(stream);
+
+    *total_cycles = 0;
+    *max_cycles = 0;
+
+    for (uint8_t pass = 0; pass < 2; ++pass) {
+        for (uint16_t row = 0; row < level->row_count; ++row) {
+            uint8_t x_coordinate = 0xFF;
+            host_cycles = 0;
+            const enum ItemType type = DecodeLevelRow(&x_coordinate);
+            const unsigned int cycles = host_cycles;
+
+            const struct LevelRow *expected = &rows[level_index][row];
+            if (type != expected->type || (type != kUnallocatedItem && x_coordinate != expected->x_coordinate)) {
+                fprintf(stderr, "level %s decodes differently at row %u\n", level->name, row);
+                return false;
+            }
+
+            if (pass == 1) {
+                *total_cycles += cycles;
+                *max_cycles = cycles > *max_cycles ? cycles : *max_cycles;
+            }
+        }
+    }
+    return true;
+}
+
+static bool WriteLevels(const char *path, const char *script_path) {
+    FILE *output = fopen(path, "w");
+    if (output == NULL) {
+        return false;
+    }
+
+    fprintf(output, "/*\n * Authored levels, generated by host/level_compile.c from %s. Do not edit.\n */\n", script_path);
+    fprintf(output, "#include <stdint.h>\n\n#include \"level.h\"\n\n");
+    fprintf(output, "const uint8_t kLevelCount = %u;\n\n", level_count);
+
+    fprintf(output, "const uint16_t kLevelOffsets[] = {");
+    for (uint8_t i = 0; i < level_count; ++i) {
+        fprintf(output, "%s%u", i == 0 ? "" : ", ", levels[i].offset);
+    }
+    fprintf(output, "};\n\n");
+
+    fprintf(output, "const uint8_t kLevelStreams[] = {");
+    for (uint8_t i = 0; i < level_count; ++i) {
+        fprintf(output, "%s\n    // %u: %s, %u rows", i == 0 ? "" : ",", i, levels[i].name, levels[i].row_count);
+        for (uint16_t byte = 0; byte < levels[i].byte_count; ++byte) {
+            fprintf(output, "%s0x%02X", byte % 12 == 0 ? "\n    " : " ", streams[levels[i].offset + byte]);
+            if (byte + 1 < levels[i].byte_count) {
+                fprintf(output, ",");
+            }
+        }
+    }
+    fprintf(output, "\n};\n");
+
+    return fclose(output) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <level script> [output file]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *script = fopen(argv[1], "r");
+    if (script == NULL) {
+        fprintf(stderr, "could not read %s\n", argv[1]);
+        return 1;
+    }
+    const bool is_parsed = ParseScript(script, argv[1]);
+    fclose(script);
+    if (!is_parsed) {
+        return 1;
+    }
+
+    unsigned long total_rows = 0;
+    unsigned int max_cycles = 0;
+    printf("%-20s %6s %6s %6s %16s %11s\n", "level", "rows", "bytes", "ratio", "cycles/turn avg", "max");
+    for (uint8_t i = 0; i < level_count; ++i) {
+        unsigned long level_cycles;
+        unsigned int level_max_cycles;
+        if (!EncodeLevel(i) || !VerifyLevel(i, &level_cycles, &level_max_cycles)) {
+            return 1;
+        }
+
+        printf("%-20s %6u %6u %5.1fx %16.1f %11u\n", levels[i].name, levels[i].row_count, levels[i].byte_count,
+               (double)levels[i].row_count / levels[i].byte_count, (double)level_cycles / levels[i].row_count, level_max_cycles);
+        total_rows += levels[i].row_count;
+        max_cycles = level_max_cycles > max_cycles ? level_max_cycles : max_cycles;
+    }
+
+    const unsigned int flash_bytes = stream_size + level_count * 2 + 1;
+    printf("%lu rows in %u bytes of flash with the offsets, %.1fx smaller than a byte per row\n",
+           total_rows, flash_bytes, (double)total_rows / flash_bytes);
+    printf("decoder: 5 bytes of RAM, %u cycles worst case per turn (%u us at 1 MHz)\n", max_cycles, max_cycles);
+
+    if (argc > 2) {
+        if (!WriteLevels(argv[2], argv[1])) {
+            fprintf(stderr, "could not write %s\n", argv[2]);
+            return 1;
+        }
+        printf("wrote %s\n", argv[2]);
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <stdint.h>
+
+#include "msp430g2553.h"
+
+// Register storage for the host build
+volatile uint8_t P1SEL, P1SEL2;
+volatile uint8_t P2DIR, P2OUT, P2SEL, P2IE, P2IES, P2IFG, P2REN;
+volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0TXBUF;
+volatile uint8_t IFG2, IE2;
+volatile uint8_t BCSCTL1, DCOCTL, BCSCTL3;
+volatile uint16_t WDTCTL;
+volatile uint8_t IE1;
+volatile uint16_t TA0CTL, TA0CCTL1, TA0CCR0, TA0CCR1, TA0IV;
+volatile uint16_t TA1CTL, TA1CCTL1, TA1CCR0, TA1CCR1;
+
+// Counted MSP430 cycles, see cycles.h
+unsigned long host_cycles = 0;
+
+// Tools that do not model interrupts wake up immediately
+__attribute__((weak)) void HostEnterLowPowerMode(const uint16_t mode) {
+    (void)mode;
+}
+
+// Without a clock to model, every read moves the timer on so seeds still differ
+__attribute__((weak)) uint16_t HostReadTimerA0() {
+    static uint16_t timer_a0 = 0x1234;
+    timer_a0 += 0x0101;
+    return timer_a0;
+}
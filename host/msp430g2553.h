@@ -0,0 +1,76 @@
+/*
+ * Host stand-in for the TI device header so the firmware sources can be compiled with a
+ * native compiler for simulation and tooling. Peripheral registers become plain variables
+ * (defined in msp430_host.c) and the low power intrinsics call into host hooks.
+ *
+ * Only the registers and bits the firmware actually touches are declared here. Host builds
+ * need -fshort-enums to match the --enum_type=packed layout the firmware relies on.
+ */
+#ifndef HOST_MSP430G2553_H_
+#define HOST_MSP430G2553_H_
+
+#include <stdint.h>
+
+// Lets firmware sources pick a plain function where they would declare an interrupt vector
+#define HOST_BUILD 1
+#define __interrupt
+
+#define BIT0 (0x0001)
+#define BIT1 (0x0002)
+#define BIT2 (0x0004)
+#define BIT3 (0x0008)
+#define BIT4 (0x0010)
+#define BIT5 (0x0020)
+#define BIT6 (0x0040)
+#define BIT7 (0x0080)
+
+// Status register
+#define GIE    (0x0008)
+#define CPUOFF (0x0010)
+
+// Entering a low power mode returns once the next interrupt would have woken the CPU
+extern void HostEnterLowPowerMode(const uint16_t mode);
+#define __bis_SR_register(mode) HostEnterLowPowerMode(mode)
+#define __bic_SR_register_on_exit(mode)
+
+// Clock system, calibration constants of a typical part
+#define CALBC1_1MHZ (0x86)
+#define CALDCO_1MHZ (0xB9)
+extern volatile uint8_t BCSCTL1, DCOCTL, BCSCTL3;
+#define LFXT1S_2 (0x20)
+
+// Watchdog timer in interval mode
+extern volatile uint16_t WDTCTL;
+extern volatile uint8_t IE1;
+#define WDT_MDLY_8 (0x5A18)
+#define WDTIE      (0x01)
+
+// Timer A0 / A1, TA0R counts SMCLK cycles since start
+extern uint16_t HostReadTimerA0();
+#define TA0R HostReadTimerA0()
+extern volatile uint16_t TA0CTL, TA0CCTL1, TA0CCR0, TA0CCR1, TA0IV;
+extern volatile uint16_t TA1CTL, TA1CCTL1, TA1CCR0, TA1CCR1;
+#define TASSEL_2     (0x0200)
+#define MC_1         (0x0010)
+#define MC_2         (0x0020)
+#define OUTMOD_7     (0x00E0)
+#define CCIE         (0x0010)
+#define TA0IV_TACCR1 (0x0002)
+
+// Port 1 / Port 2
+extern volatile uint8_t P1SEL, P1SEL2;
+extern volatile uint8_t P2DIR, P2OUT, P2SEL, P2IE, P2IES, P2IFG, P2REN;
+
+// USCI_A0 in SPI mode
+extern volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0TXBUF;
+extern volatile uint8_t IFG2, IE2;
+#define UCCKPH    (0x80)
+#define UCMSB     (0x20)
+#define UCMST     (0x08)
+#define UCSYNC    (0x01)
+#define UCSSEL_2  (0x80)
+#define UCSWRST   (0x01)
+#define UCA0TXIFG (0x02)
+#define UCA0TXIE  (0x02)
+
+#endif /* HOST_MSP430G2553_H_ */
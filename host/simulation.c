@@ -0,0 +1,35 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "rand.h"
+#include "simulation.h"
+
+
+extern void StartGame(const uint16_t seed) {
+    ResetGameState();
+    srand(seed == 0 ? 1 : seed);
+}
+
+extern bool BeginTurn() {
+    if (IsGameLost()) {
+        return false;
+    }
+
+    UpdateItemsPosition();
+    HandleItemGeneration();
+    return true;
+}
+
+extern enum Outcome EndTurn(const enum Button button) {
+    UpdatePlayerPosition(button);
+
+    if (IsGameWon()) {
+        return kWon;
+    } else if (IsGameLost()) {
+        return kLost;
+    }
+
+    ConsumeTurn();
+    return IsGameLost() ? kLost : kPlaying;
+}
@@ -0,0 +1,24 @@
+#ifndef HOST_SIMULATION_H_
+#define HOST_SIMULATION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+
+enum Outcome {
+    kPlaying,
+    kWon,
+    kLost
+};
+
+// Starts a game that only depends on the seed
+extern void StartGame(const uint16_t seed);
+
+// First half of HandleTurn in main.c, up to the point where the button is read
+extern bool BeginTurn();
+
+// Second half of HandleTurn in main.c, running out of time counts as a loss right away
+extern enum Outcome EndTurn(const enum Button button);
+
+#endif /* HOST_SIMULATION_H_ */
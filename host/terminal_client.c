@@ -0,0 +1,291 @@
+/*
+ * Runs the unmodified firmware on the host and plays it in a terminal.
+ *
+ * Build from the repository root (the firmware main() is renamed so the client can own main):
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -Dmain=firmware_main -c main.c -o firmware_main.o
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o terminal_client host/terminal_client.c firmware_main.o \
+ *       host/msp430_host.c graphics.c sound.c game.c level.c levels.c rand.c autopilot.c \
+ *       autopilot_policy.c -lm
+ *   ./terminal_client                      arrow keys move, q quits
+ *
+ * Every time the firmware enters low power mode the client decides which interrupt wakes it:
+ *   - a pending USCI transmit interrupt takes the byte from UCA0TXBUF into an APA102 frame
+ *     decoder, and adds the MSP430 cycles the firmware ran since the last wake (host_cycles, see
+ *     cycles.h; SendSpiByte() and the frame expansion around it are counted in graphics.c) at
+ *     1 us each, so a frame takes as long as the cycle model says
+ *   - otherwise it waits for the next watchdog tick (8192 SMCLK cycles) or a key, whichever
+ *     comes first, and runs the same ISR the hardware would
+ * Ticks that fall inside a frame transfer wake SendSpiByte instead of sleep(), as on hardware,
+ * so the turn period includes the frame time. Only LEDs that changed are redrawn.
+ *
+ * Below the board the client shows the keypress to frame latency (key read until the frame
+ * drawn after it) and the frame period with its jitter over the last kPeriodWindow frames. The
+ * firmware paces frames by counting wakes from low power mode (sleep() in main.c): a turn is 20
+ * wakes, an animation step 1 to 3. The window only holds frames of one cadence, and starts over
+ * when the number of watchdog and key wakes between frames changes, so the spiral and the turns
+ * are never mixed into one jitter figure.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "msp430g2553.h"
+
+#include "cycles.h"
+
+// Firmware entry point and interrupt handlers from main.c
+extern int firmware_main();
+extern void watchdog_timer(void);
+extern void port_2(void);
+extern void USCIB0TX_ISR(void);
+
+static const int64_t kWatchdogPeriod = 8192000;     // ns, WDT_MDLY_8 at 1 MHz SMCLK
+static const int64_t kCyclePeriod = 1000;           // ns per MSP430 cycle at 1 MHz
+static const uint16_t kFrameBytes = 4 + 65 * 4 + 4; // start frame, status LED and screen, end frame
+static const uint8_t kLedCount = 65;
+enum { kPeriodWindow = 64 };
+
+static const int kBoardTop = 3;     // terminal row of the first screen row
+static const int kBoardLeft = 3;    // terminal column of the first screen column
+
+static struct termios original_terminal;
+static int64_t start_time;
+static int64_t next_watchdog_tick;
+static int64_t spi_backlog;
+
+static uint16_t frame_position;
+static uint8_t frame_colors[65][3];     // r, g, b as decoded from the wire
+static uint8_t drawn_colors[65][3];
+static bool is_drawn[65];
+
+static int64_t pending_key_time = -1;
+static int64_t last_latency = -1;
+static int64_t max_latency = 0;
+static int64_t total_latency = 0;
+static unsigned long latency_count = 0;
+
+static int64_t last_frame_time = -1;
+static int64_t frame_periods[kPeriodWindow];
+static unsigned long frame_count = 0;
+static unsigned int frame_wakes = 0;        // watchdog and key wakes since the last frame
+static unsigned int frame_cadence = 0;      // wakes per frame of the frames in the window
+
+
+static int64_t GetTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void SleepUntil(const int64_t deadline) {
+    const int64_t remaining = deadline - GetTime();
+    if (remaining > 0) {
+        const struct timespec duration = {remaining / 1000000000, remaining % 1000000000};
+        nanosleep(&duration, NULL);
+    }
+}
+
+static void RestoreTerminal() {
+    static const char kReset[] = "\x1b[0m\x1b[?25h\x1b[2J\x1b[H";
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &original_terminal);
+    if (write(STDOUT_FILENO, kReset, sizeof(kReset) - 1) < 0) {
+        // Nothing left to report it to
+    }
+}
+
+static void HandleSignal(int signal_number) {
+    (void)signal_number;
+    RestoreTerminal();
+    _exit(0);
+}
+
+static void SetUpTerminal() {
+    tcgetattr(STDIN_FILENO, &original_terminal);
+    atexit(RestoreTerminal);
+    signal(SIGINT, HandleSignal);
+    signal(SIGTERM, HandleSignal);
+
+    struct termios raw = original_terminal;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+
+    printf("\x1b[?25l\x1b[2J\x1b[1;1HBitDodger  arrows move, q quits");
+    fflush(stdout);
+}
+
+static void DrawLed(const int row, const int column, const uint8_t *color) {
+    printf("\x1b[%d;%dH\x1b[48;2;%u;%u;%um  \x1b[0m", row, column, color[0], color[1], color[2]);
+}
+
+static int64_t GetAverage(const int64_t total, const unsigned long count) {
+    return count == 0 ? 0 : total / (int64_t)count;
+}
+
+static void DrawMetrics() {
+    const unsigned long window = frame_count < kPeriodWindow ? frame_count : kPeriodWindow;
+    int64_t total = 0;
+    int64_t longest = 0;
+    for (unsigned long i = 0; i < window; ++i) {
+        total += frame_periods[i];
+        longest = frame_periods[i] > longest ? frame_periods[i] : longest;
+    }
+    const int64_t mean = GetAverage(total, window);
+
+    double variance = 0;
+    for (unsigned long i = 0; i < window; ++i) {
+        variance += (double)(frame_periods[i] - mean) * (frame_periods[i] - mean);
+    }
+    const double jitter = window == 0 ? 0 : sqrt(variance / window);
+
+    printf("\x1b[%d;1H\x1b[Kkey to frame: last %6.1f ms  mean %6.1f ms  max %6.1f ms  (%lu keys)",
+           kBoardTop + 9, last_latency < 0 ? 0 : last_latency / 1e6, GetAverage(total_latency, latency_count) / 1e6,
+           max_latency / 1e6, latency_count);
+    printf("\x1b[%d;1H\x1b[Kframe period: mean %6.1f ms  jitter %5.2f ms  max %6.1f ms  (last %lu frames of %u wakes)",
+           kBoardTop + 10, mean / 1e6, jitter / 1e6, longest / 1e6, window, frame_cadence);
+}
+
+// Redraws the LEDs that changed since the last frame, then the metrics
+static void DrawFrame() {
+    for (uint8_t led = 0; led < kLedCount; ++led) {
+        if (is_drawn[led] && memcmp(drawn_colors[led], frame_colors[led], 3) == 0) {
+            continue;
+        }
+
+        if (led == 0) {
+            DrawLed(kBoardTop - 1, kBoardLeft + 20, frame_colors[led]);    // status LED
+        } else {
+            // LED 1 + y * 8 + (7 - x), so columns are already in screen order
+            DrawLed(kBoardTop + (led - 1) / 8, kBoardLeft + 2 * ((led - 1) % 8), frame_colors[led]);
+        }
+        memcpy(drawn_colors[led], frame_colors[led], 3);
+        is_drawn[led] = true;
+    }
+
+    DrawMetrics();
+    fflush(stdout);
+
+    const int64_t now = GetTime();
+    if (pending_key_time >= 0) {
+        last_latency = now - pending_key_time;
+        max_latency = last_latency > max_latency ? last_latency : max_latency;
+        total_latency += last_latency;
+        ++latency_count;
+        pending_key_time = -1;
+    }
+    if (last_frame_time >= 0) {
+        if (frame_wakes != frame_cadence) {
+            frame_cadence = frame_wakes;
+            frame_count = 0;
+        }
+        frame_periods[frame_count++ % kPeriodWindow] = now - last_frame_time;
+    }
+    last_frame_time = now;
+    frame_wakes = 0;
+}
+
+// APA102 stream: 4 zero bytes, then brightness, blue, green, red per LED, then 4 end bytes
+static void DecodeSpiByte(const uint8_t byte) {
+    if (frame_position >= 4 && frame_position < 4 + kLedCount * 4) {
+        const uint8_t led = (frame_position - 4) / 4;
+        switch ((frame_position - 4) % 4) {
+            case 1: frame_colors[led][2] = byte; break;
+            case 2: frame_colors[led][1] = byte; break;
+            case 3: frame_colors[led][0] = byte; break;
+        }
+    }
+
+    if (++frame_position == kFrameBytes) {
+        frame_position = 0;
+        SleepUntil(GetTime() + spi_backlog);    // the frame is only visible once it is all out
+        spi_backlog = 0;
+        DrawFrame();
+    }
+}
+
+// Returns true if a button was pressed
+static bool ReadKeys(const int64_t now) {
+    char keys[16];
+    const ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+    bool is_pressed = false;
+
+    for (ssize_t i = 0; i < count; ++i) {
+        if (keys[i] == 'q') {
+            exit(0);
+        }
+
+        // Arrow keys arrive as ESC [ C / ESC [ D
+        if (keys[i] == '\x1b' && i + 2 < count && keys[i + 1] == '[' && (keys[i + 2] == 'C' || keys[i + 2] == 'D')) {
+            P2IFG = keys[i + 2] == 'D' ? BIT0 : BIT2;   // left is the P2.0 button
+            port_2();
+            is_pressed = true;
+            i += 2;
+        }
+    }
+
+    if (is_pressed && pending_key_time < 0) {
+        pending_key_time = now;
+    }
+    return is_pressed;
+}
+
+uint16_t HostReadTimerA0() {
+    return (uint16_t)((GetTime() - start_time) / 1000);   // 1 MHz SMCLK
+}
+
+void HostEnterLowPowerMode(const uint16_t mode) {
+    (void)mode;
+
+    // SendSpiByte sleeps with the transmit interrupt enabled, which fires as soon as the byte is taken
+    if ((IE2 & UCA0TXIE) && (IFG2 & UCA0TXIFG)) {
+        spi_backlog += (int64_t)host_cycles * kCyclePeriod;
+        host_cycles = 0;
+        DecodeSpiByte(UCA0TXBUF);
+        USCIB0TX_ISR();
+        return;
+    }
+
+    // Watchdog ticks during the frame transfer were spent waking SendSpiByte
+    while (next_watchdog_tick <= GetTime()) {
+        next_watchdog_tick += kWatchdogPeriod;
+    }
+
+    while (true) {
+        const int64_t now = GetTime();
+        if (now >= next_watchdog_tick) {
+            next_watchdog_tick += kWatchdogPeriod;
+            ++frame_wakes;
+            host_cycles = 0;        // only work done after the wake delays the next frame
+            watchdog_timer();
+            return;
+        }
+
+        fd_set keyboard;
+        FD_ZERO(&keyboard);
+        FD_SET(STDIN_FILENO, &keyboard);
+        struct timeval timeout = {0, (next_watchdog_tick - now) / 1000};
+        if (select(STDIN_FILENO + 1, &keyboard, NULL, NULL, &timeout) > 0 && ReadKeys(GetTime())) {
+            ++frame_wakes;
+            host_cycles = 0;
+            return;
+        }
+    }
+}
+
+int main() {
+    SetUpTerminal();
+    start_time = GetTime();
+    next_watchdog_tick = start_time + kWatchdogPeriod;
+    return firmware_main();
+}
@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "trace.h"
+
+const uint32_t kTraceBlockMagic = 0x4B424442u; // "BDBK"
+
+static const char kTraceFileMagic[8] = "BDTRACE";
+static const uint32_t kTraceVersion = 2;
+
+static const uint8_t kTracePadding[8] = {0};
+
+
+static uint32_t AlignTraceOffset(const uint32_t offset) {
+    return (offset + 7) & ~(uint32_t)7;
+}
+
+extern int CreateTraceFile(const char *path) {
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kTraceFileMagic, sizeof(header.magic));
+    header.version = kTraceVersion;
+
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+extern void InitializeTraceWriter(struct TraceWriter *writer, const int fd) {
+    writer->fd = fd;
+    writer->record_count = 0;
+    writer->game_count = 0;
+}
+
+extern bool AppendTraceRecord(struct TraceWriter *writer, const struct TraceRecord *record) {
+    if (writer->record_count == kTraceBlockRecords && !FlushTraceWriter(writer)) {
+        return false;
+    }
+
+    const uint32_t record_index = writer->record_count++;
+
+    // A record that does not continue the previous one starts a new game entry, and so does one
+    // whose item rows are not the previous rows moved down by one
+    if (writer->game_count == 0 || record->game_id != writer->last_game_id || record->turn != (uint16_t)(writer->last_turn + 1)
+            || memcmp(record->item_rows + 1, writer->last_item_rows, kTraceScreenRows - 1) != 0) {
+        struct TraceGame *game = &writer->games[writer->game_count++];
+        game->game_id = record->game_id;
+        game->seed = record->seed;
+        game->first_turn = record->turn;
+        game->first_record = record_index;
+        memcpy(game->item_rows, record->item_rows, kTraceScreenRows);
+    }
+    writer->last_game_id = record->game_id;
+    writer->last_turn = record->turn;
+    memcpy(writer->last_item_rows, record->item_rows, kTraceScreenRows);
+
+    writer->item_rows[record_index] = record->item_rows[0];
+    writer->remaining_turns[record_index] = record->remaining_turns;
+    writer->controls[record_index] = (record->player_x_coordinate & 0x07) | ((record->button & 0x03) << 3) | ((record->outcome & 0x03) << 5);
+    return true;
+}
+
+extern bool FlushTraceWriter(struct TraceWriter *writer) {
+    if (writer->record_count == 0) {
+        return true;
+    }
+
+    const uint32_t record_count = writer->record_count;
+    const uint32_t games_size = writer->game_count * sizeof(struct TraceGame);
+
+    struct TraceBlockHeader header;
+    header.magic = kTraceBlockMagic;
+    header.record_count = record_count;
+    header.game_count = writer->game_count;
+    header.item_rows_offset = AlignTraceOffset(sizeof(header) + games_size);
+    header.remaining_turns_offset = header.item_rows_offset + record_count;
+    header.controls_offset = header.remaining_turns_offset + record_count;
+    header.block_size = AlignTraceOffset(header.controls_offset + record_count);
+
+    header.min_game_id = UINT32_MAX;
+    header.max_game_id = 0;
+    for (uint32_t i = 0; i < writer->game_count; ++i) {
+        if (writer->games[i].game_id < header.min_game_id) {
+            header.min_game_id = writer->games[i].game_id;
+        }
+        if (writer->games[i].game_id > header.max_game_id) {
+            header.max_game_id = writer->games[i].game_id;
+        }
+    }
+
+    // One gathered write per block keeps appends from different writers from interleaving
+    const struct iovec parts[] = {
+        {&header, sizeof(header)},
+        {writer->games, games_size},
+        {(void *)kTracePadding, header.item_rows_offset - sizeof(header) - games_size},
+        {writer->item_rows, record_count},
+        {writer->remaining_turns, record_count},
+        {writer->controls, record_count},
+        {(void *)kTracePadding, header.block_size - header.controls_offset - record_count}
+    };
+
+    const ssize_t written = writev(writer->fd, parts, sizeof(parts) / sizeof(parts[0]));
+
+    writer->record_count = 0;
+    writer->game_count = 0;
+    return written == (ssize_t)header.block_size;
+}
+
+extern void CaptureTraceRecord(struct TraceRecord *record, const uint32_t game_id, const uint16_t seed, const uint16_t turn) {
+    record->game_id = game_id;
+    record->seed = seed;
+    record->turn = turn;
+    record->player_x_coordinate = GetPlayerXCoordinate();
+    record->remaining_turns = (int8_t)GetRemainingTurns();
+    record->button = kNoButton;
+    record->outcome = kPlaying;
+
+    memset(record->item_rows, 0, sizeof(record->item_rows));
+    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
+        if (!IsItemUnallocated(item_index)) {
+            const struct Item *item = GetItem(item_index);
+            record->item_rows[item->y_coordinate & 0x07] = (item->type << 3) | item->x_coordinate;
+        }
+    }
+}
+
+extern bool MapTraceFile(struct TraceFile *trace, const char *path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || (size_t)file_status.st_size < sizeof(struct TraceFileHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, file_status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    const struct TraceFileHeader *header = data;
+    if (memcmp(header->magic, kTraceFileMagic, sizeof(header->magic)) != 0 || header->version != kTraceVersion) {
+        munmap(data, file_status.st_size);
+        return false;
+    }
+
+    posix_madvise(data, file_status.st_size, POSIX_MADV_SEQUENTIAL);
+    trace->data = data;
+    trace->size = file_status.st_size;
+    return true;
+}
+
+extern void UnmapTraceFile(struct TraceFile *trace) {
+    munmap((void *)trace->data, trace->size);
+    trace->data = NULL;
+    trace->size = 0;
+}
+
+static const struct TraceBlockHeader *GetTraceBlockAt(const struct TraceFile *trace, const size_t offset) {
+    if (offset + sizeof(struct TraceBlockHeader) > trace->size) {
+        return NULL;
+    }
+
+    const struct TraceBlockHeader *block = (const struct TraceBlockHeader *)(trace->data + offset);
+    const bool is_valid = block->magic == kTraceBlockMagic
+            && block->block_size <= trace->size - offset
+            && block->record_count <= kTraceBlockRecords
+            && block->game_count <= block->record_count
+            && sizeof(*block) + block->game_count * sizeof(struct TraceGame) <= block->item_rows_offset
+            && block->item_rows_offset + block->record_count <= block->remaining_turns_offset
+            && block->remaining_turns_offset + block->record_count <= block->controls_offset
+            && block->controls_offset + block->record_count <= block->block_size;
+    return is_valid ? block : NULL;
+}
+
+extern const struct TraceBlockHeader *GetFirstTraceBlock(const struct TraceFile *trace) {
+    return GetTraceBlockAt(trace, sizeof(struct TraceFileHeader));
+}
+
+extern const struct TraceBlockHeader *GetNextTraceBlock(const struct TraceFile *trace, const struct TraceBlockHeader *block) {
+    return GetTraceBlockAt(trace, (const uint8_t *)block - trace->data + block->block_size);
+}
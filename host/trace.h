@@ -0,0 +1,156 @@
+/*
+ * Columnar binary trace of simulated turns, for corpora far too large for text logs.
+ *
+ * A trace file is a small file header followed by self describing blocks. Every block holds up
+ * to kTraceBlockRecords turns stored column by column:
+ *
+ *   struct TraceBlockHeader   record and game counts, game id range, column offsets
+ *   struct TraceGame[]        per block game index: game id, seed, turn and record of each game's
+ *                             first record in the block, and a snapshot of its item rows
+ *   uint8_t[]                 new item row, the top screen row: (type << 3) | x, 0 if empty
+ *   int8_t[]                  remaining turns when the button is read
+ *   uint8_t[]                 controls, bit packed: player x | button << 3 | outcome << 5
+ *
+ * Items fall one row per turn, so the item rows of a record are those of the record before it
+ * moved down one row, plus the new top row. Only that row is stored per turn, the other seven
+ * come from the snapshot in the game index (see ShiftTraceItemRows). Should the rows ever not
+ * follow from the record before, the writer starts a new game index entry with a fresh snapshot.
+ * A turn takes 3 bytes instead of 10.
+ *
+ * Games are identified by a 32 bit game id, seeds repeat in large corpora. Columns are fixed
+ * width and 8 byte aligned, so a mapped file is scanned in place. All values are little endian,
+ * which is every host this runs on.
+ *
+ * Writers fill a private block and append it with a single O_APPEND write, so any number of
+ * threads or processes can share one file descriptor without locking. Blocks from different
+ * writers interleave, but a game never spans writers.
+ */
+#ifndef HOST_TRACE_H_
+#define HOST_TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "simulation.h"
+
+enum {
+    kTraceBlockRecords = 16384,
+    kTraceScreenRows = 8,
+    kTraceMaxGames = kTraceBlockRecords
+};
+
+struct TraceFileHeader {
+    char magic[8];              // "BDTRACE\0"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct TraceBlockHeader {
+    uint32_t magic;             // kTraceBlockMagic
+    uint32_t block_size;        // bytes including this header, a multiple of 8
+    uint32_t record_count;
+    uint32_t game_count;
+    uint32_t min_game_id;
+    uint32_t max_game_id;
+    uint32_t item_rows_offset;  // column offsets from the start of the block
+    uint32_t remaining_turns_offset;
+    uint32_t controls_offset;
+};
+
+struct TraceGame {
+    uint32_t game_id;
+    uint16_t seed;
+    uint16_t first_turn;        // turn number of the game's first record in this block
+    uint32_t first_record;
+    uint8_t item_rows[kTraceScreenRows];    // item rows of the first record
+};
+
+// One turn as handed to the writer
+struct TraceRecord {
+    uint32_t game_id;
+    uint16_t seed;
+    uint16_t turn;
+    uint8_t player_x_coordinate;
+    int8_t remaining_turns;
+    uint8_t item_rows[kTraceScreenRows];
+    enum Button button;
+    enum Outcome outcome;
+};
+
+struct TraceWriter {
+    int fd;
+    uint32_t record_count;
+    uint32_t game_count;
+    uint32_t last_game_id;
+    uint16_t last_turn;
+    uint8_t last_item_rows[kTraceScreenRows];
+    struct TraceGame games[kTraceMaxGames];
+    uint8_t item_rows[kTraceBlockRecords];
+    int8_t remaining_turns[kTraceBlockRecords];
+    uint8_t controls[kTraceBlockRecords];
+};
+
+struct TraceFile {
+    const uint8_t *data;
+    size_t size;
+};
+
+extern const uint32_t kTraceBlockMagic;
+
+// Creates or truncates a trace file and returns an O_APPEND descriptor for writers, -1 on error
+extern int CreateTraceFile(const char *path);
+
+// Writers are large, allocate them statically or on the heap rather than on the stack
+extern void InitializeTraceWriter(struct TraceWriter *writer, const int fd);
+extern bool AppendTraceRecord(struct TraceWriter *writer, const struct TraceRecord *record);
+extern bool FlushTraceWriter(struct TraceWriter *writer);
+
+// Fills a record from the current game state, before the button is applied
+extern void CaptureTraceRecord(struct TraceRecord *record, const uint32_t game_id, const uint16_t seed, const uint16_t turn);
+
+extern bool MapTraceFile(struct TraceFile *trace, const char *path);
+extern void UnmapTraceFile(struct TraceFile *trace);
+
+// Walks the blocks of a mapped trace, NULL at the end or at the first damaged block
+extern const struct TraceBlockHeader *GetFirstTraceBlock(const struct TraceFile *trace);
+extern const struct TraceBlockHeader *GetNextTraceBlock(const struct TraceFile *trace, const struct TraceBlockHeader *block);
+
+static inline const struct TraceGame *GetTraceGames(const struct TraceBlockHeader *block) {
+    return (const struct TraceGame *)(block + 1);
+}
+
+static inline const uint8_t *GetTraceItemRows(const struct TraceBlockHeader *block) {
+    return (const uint8_t *)block + block->item_rows_offset;
+}
+
+// Turns the item rows of one record into those of the next, given the next record's new row
+static inline void ShiftTraceItemRows(uint8_t item_rows[kTraceScreenRows], const uint8_t new_row) {
+    for (uint8_t y = kTraceScreenRows - 1; y > 0; --y) {
+        item_rows[y] = item_rows[y - 1];
+    }
+    item_rows[0] = new_row;
+}
+
+static inline const int8_t *GetTraceRemainingTurns(const struct TraceBlockHeader *block) {
+    return (const int8_t *)((const uint8_t *)block + block->remaining_turns_offset);
+}
+
+static inline const uint8_t *GetTraceControls(const struct TraceBlockHeader *block) {
+    return (const uint8_t *)block + block->controls_offset;
+}
+
+static inline uint8_t GetTracePlayerX(const uint8_t controls) {
+    return controls & 0x07;
+}
+
+static inline enum Button GetTraceButton(const uint8_t controls) {
+    return (enum Button)((controls >> 3) & 0x03);
+}
+
+static inline enum Outcome GetTraceOutcome(const uint8_t controls) {
+    return (enum Outcome)((controls >> 5) & 0x03);
+}
+
+#endif /* HOST_TRACE_H_ */
@@ -0,0 +1,169 @@
+/*
+ * Reads a columnar trace (see trace.h) straight out of the mapped file.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o trace_analyze host/trace_analyze.c host/trace.c \
+ *       host/simulation.c host/msp430_host.c game.c level.c levels.c graphics.c rand.c
+ *   ./trace_analyze <trace file>           win rate and game length over the whole trace
+ *   ./trace_analyze <trace file> <game>    replays the game with that game id
+ *
+ * The replay runs the recorded buttons through the game rules again and stops at the first turn
+ * where the simulation no longer matches the trace.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "simulation.h"
+#include "trace.h"
+
+
+static double GetSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Win rate only needs the controls column, one byte per turn
+static int AnalyzeTrace(const struct TraceFile *trace) {
+    const double start = GetSeconds();
+    unsigned long blocks = 0;
+    unsigned long long records = 0;
+    unsigned long long wins = 0;
+    unsigned long long losses = 0;
+
+    for (const struct TraceBlockHeader *block = GetFirstTraceBlock(trace); block != NULL; block = GetNextTraceBlock(trace, block)) {
+        const uint8_t *controls = GetTraceControls(block);
+        for (uint32_t i = 0; i < block->record_count; ++i) {
+            const enum Outcome outcome = GetTraceOutcome(controls[i]);
+            wins += outcome == kWon;
+            losses += outcome == kLost;
+        }
+
+        records += block->record_count;
+        ++blocks;
+    }
+
+    const double seconds = GetSeconds() - start;
+    const unsigned long long games = wins + losses;
+    printf("%lu blocks, %llu turns, %llu finished games\n", blocks, records, games);
+    if (games > 0) {
+        printf("win rate %.2f%%, %.1f turns per game\n", 100.0 * wins / games, (double)records / games);
+    }
+    printf("scanned %.1f MB in %.3f s\n", trace->size / 1e6, seconds);
+    return 0;
+}
+
+// Same orientation as the LED matrix: x counts up to the left
+static void PrintTurn(const uint16_t turn, const uint8_t item_rows[kTraceScreenRows], const uint8_t controls, const int8_t remaining_turns) {
+    static const char kButtonNames[][6] = {"-", "left", "right"};
+
+    printf("turn %u: %d turns left, pressed %s\n", turn, remaining_turns, kButtonNames[GetTraceButton(controls)]);
+    for (uint8_t y = 0; y < kTraceScreenRows; ++y) {
+        char row[kTraceScreenRows + 1];
+        memset(row, '.', kTraceScreenRows);
+        row[kTraceScreenRows] = '\0';
+
+        if (item_rows[y] != 0) {
+            const uint8_t type = item_rows[y] >> 3;
+            row[kTraceScreenRows - 1 - (item_rows[y] & 0x07)] = type < kItemTypeCount && kItemTypes[type].turn_delta < 0 ? 'x' : 'o';
+        }
+        if (y == kTraceScreenRows - 1) {
+            // '*' only when the item in the player row is in the player's column, a catch
+            const bool is_caught = item_rows[y] != 0 && (item_rows[y] & 0x07) == GetTracePlayerX(controls);
+            row[kTraceScreenRows - 1 - GetTracePlayerX(controls)] = is_caught ? '*' : 'P';
+        }
+        printf("  %s\n", row);
+    }
+}
+
+static bool IsMatchingTurn(const uint8_t item_rows[kTraceScreenRows], const uint8_t controls, const int8_t remaining_turns) {
+    struct TraceRecord record;
+    CaptureTraceRecord(&record, 0, 0, 0);
+    return memcmp(record.item_rows, item_rows, kTraceScreenRows) == 0
+            && record.player_x_coordinate == GetTracePlayerX(controls)
+            && record.remaining_turns == remaining_turns;
+}
+
+static int ReplayGame(const struct TraceFile *trace, const uint32_t game_id) {
+    bool is_found = false;
+    uint16_t next_turn = 0;
+
+    // A long game continues in later blocks of the same writer, or in a later entry of the same
+    // block where the writer took a new item row snapshot
+    for (const struct TraceBlockHeader *block = GetFirstTraceBlock(trace); block != NULL; block = GetNextTraceBlock(trace, block)) {
+        if (game_id < block->min_game_id || game_id > block->max_game_id) {
+            continue;
+        }
+
+        const struct TraceGame *games = GetTraceGames(block);
+        for (uint32_t game = 0; game < block->game_count; ++game) {
+            if (games[game].game_id != game_id || games[game].first_turn != next_turn) {
+                continue;
+            }
+            if (!is_found) {
+                StartGame(games[game].seed);
+                is_found = true;
+            }
+
+            const uint32_t end = game + 1 < block->game_count ? games[game + 1].first_record : block->record_count;
+            const uint8_t *new_rows = GetTraceItemRows(block);
+            const int8_t *remaining_turns = GetTraceRemainingTurns(block);
+            const uint8_t *controls = GetTraceControls(block);
+
+            uint8_t item_rows[kTraceScreenRows];
+            memcpy(item_rows, games[game].item_rows, kTraceScreenRows);
+            for (uint32_t i = games[game].first_record; i < end; ++i, ++next_turn) {
+                if (i != games[game].first_record) {
+                    ShiftTraceItemRows(item_rows, new_rows[i]);
+                }
+                PrintTurn(next_turn, item_rows, controls[i], remaining_turns[i]);
+
+                if (!BeginTurn() || !IsMatchingTurn(item_rows, controls[i], remaining_turns[i])) {
+                    printf("replay diverges from the trace at turn %u\n", next_turn);
+                    return 1;
+                }
+
+                const enum Outcome outcome = EndTurn(GetTraceButton(controls[i]));
+                if (outcome != GetTraceOutcome(controls[i])) {
+                    printf("replay diverges from the trace at turn %u\n", next_turn);
+                    return 1;
+                } else if (outcome != kPlaying) {
+                    printf("game %s after %u turns, replay matches the trace\n", outcome == kWon ? "won" : "lost", next_turn + 1);
+                    return 0;
+                }
+            }
+        }
+    }
+
+    if (!is_found) {
+        printf("no game %u in the trace\n", (unsigned int)game_id);
+        return 1;
+    }
+
+    printf("trace ends before the game does, replay matches for %u turns\n", next_turn);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long game_id = 0;
+    if (argc < 2 || (argc > 2 && sscanf(argv[2], "%lu", &game_id) != 1) || game_id > UINT32_MAX) {
+        fprintf(stderr, "usage: %s <trace file> [game]\n", argv[0]);
+        return 1;
+    }
+
+    struct TraceFile trace;
+    if (!MapTraceFile(&trace, argv[1])) {
+        fprintf(stderr, "could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    const int result = argc > 2 ? ReplayGame(&trace, (uint32_t)game_id) : AnalyzeTrace(&trace);
+    UnmapTraceFile(&trace);
+    return result;
+}
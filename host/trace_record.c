@@ -0,0 +1,131 @@
+/*
+ * Plays games with the autopilot and records every turn into a columnar trace (see trace.h).
+ *
+ * Build and run from the repository root:
+ *   gcc -std=c99 -O2 -fshort-enums -Ihost -I. -o trace_record host/trace_record.c host/trace.c \
+ *       host/simulation.c host/msp430_host.c game.c level.c levels.c autopilot.c \
+ *       autopilot_policy.c graphics.c rand.c
+ *   ./trace_record <trace file> [games] [workers] [random move percent]
+ *
+ * The game keeps its state in file scope variables like the firmware does, so every worker is a
+ * separate process. They all append to the same descriptor; see trace.h for why that is safe.
+ * Game g has game id g and seed g % 65535 + 1. Seeds repeat past 65535 games, and a small share of
+ * random moves keeps games with the same seed apart.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "autopilot.h"
+#include "game.h"
+#include "simulation.h"
+#include "trace.h"
+
+static const unsigned long kDefaultGames = 100000;
+static const unsigned int kDefaultWorkers = 4;
+static const unsigned int kDefaultRandomMovePercent = 5;
+static const uint16_t kMaxGameTurns = 5000;
+
+static struct TraceWriter writer;
+
+
+static uint32_t NextMoveRandom(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static bool RecordGame(const uint32_t game_id, const unsigned int random_move_percent, uint32_t *random_state) {
+    const uint16_t seed = (uint16_t)(game_id % 65535 + 1);
+    StartGame(seed);
+
+    struct TraceRecord record;
+    for (uint16_t turn = 0; turn < kMaxGameTurns && BeginTurn(); ++turn) {
+        CaptureTraceRecord(&record, game_id, seed, turn);
+
+        record.button = GetAutopilotButton();
+        if (NextMoveRandom(random_state) % 100 < random_move_percent) {
+            record.button = (enum Button)(NextMoveRandom(random_state) % 3);
+        }
+        record.outcome = EndTurn(record.button);
+
+        if (!AppendTraceRecord(&writer, &record)) {
+            return false;
+        }
+        if (record.outcome != kPlaying) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+static int RunWorker(const int fd, const unsigned int worker, const unsigned int workers, const unsigned long games,
+                     const unsigned int random_move_percent) {
+    uint32_t random_state = 0x9E3779B9u ^ (worker + 1);
+    InitializeTraceWriter(&writer, fd);
+
+    for (unsigned long game = worker; game < games; game += workers) {
+        if (!RecordGame((uint32_t)game, random_move_percent, &random_state)) {
+            return 1;
+        }
+    }
+
+    return FlushTraceWriter(&writer) ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long games = kDefaultGames;
+    unsigned int workers = kDefaultWorkers;
+    unsigned int random_move_percent = kDefaultRandomMovePercent;
+
+    if (argc < 2 || (argc > 2 && sscanf(argv[2], "%lu", &games) != 1) || (argc > 3 && sscanf(argv[3], "%u", &workers) != 1)
+            || (argc > 4 && sscanf(argv[4], "%u", &random_move_percent) != 1) || workers == 0) {
+        fprintf(stderr, "usage: %s <trace file> [games] [workers] [random move percent]\n", argv[0]);
+        return 1;
+    }
+
+    const int fd = CreateTraceFile(argv[1]);
+    if (fd < 0) {
+        fprintf(stderr, "could not create %s\n", argv[1]);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned int worker = 0; worker < workers; ++worker) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            fprintf(stderr, "could not start worker %u\n", worker);
+            return 1;
+        } else if (pid == 0) {
+            _exit(RunWorker(fd, worker, workers, games, random_move_percent));
+        }
+    }
+
+    bool is_success = true;
+    int status;
+    while (wait(&status) > 0) {
+        is_success = is_success && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const off_t size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    if (!is_success) {
+        fprintf(stderr, "a worker failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    const double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("recorded %lu games with %u workers in %.2f s, %.1f MB\n", games, workers, seconds, size / 1e6);
+    return 0;
+}
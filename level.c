@@ -0,0 +1,45 @@
+#include <stdint.h>
+
+#include "cycles.h"
+#include "game.h"
+#include "level.h"
+
+// Decoder state, 5 bytes of RAM
+static const uint8_t *level_start;
+static const uint8_t *level_cursor;
+static uint8_t empty_rows_left = 0;
+
+
+extern void StartLevelStream(const uint8_t *stream) {
+    level_start = stream;
+    level_cursor = level_start;
+    empty_rows_left = 0;
+}
+
+// Returns the item type spawned this turn, kUnallocatedItem for an empty row. Reads at most two codes.
+extern enum ItemType DecodeLevelRow(uint8_t *x_coordinate) {
+    if (empty_rows_left != 0) {
+        COUNT_CYCLES(19);   // call, test, branch, decrement, return value, ret
+        --empty_rows_left;
+        return kUnallocatedItem;
+    }
+
+    COUNT_CYCLES(23);       // call, test and branch, fetch the code, store the cursor, end code test
+    uint8_t code = *level_cursor++;
+    if (code == kLevelEndCode) {
+        COUNT_CYCLES(8);    // fetch again from the start of the stream
+        level_cursor = level_start;
+        code = *level_cursor++;
+    }
+
+    if (code & kLevelItemFlag) {
+        COUNT_CYCLES(32);   // item test, x, trailing empty rows, type, ret
+        *x_coordinate = code & 0x07;
+        empty_rows_left = (code >> 3) & 0x03;
+        return (enum ItemType)((code >> 5) & 0x03);
+    }
+
+    COUNT_CYCLES(13);       // item test, store the run, return value, ret
+    empty_rows_left = code - 1;
+    return kUnallocatedItem;
+}
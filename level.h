@@ -0,0 +1,33 @@
+#ifndef LEVEL_H_
+#define LEVEL_H_
+
+#include <stdint.h>
+
+#include "game.h"
+
+/*
+ * Authored levels are streams of one byte codes, one spawn row is decoded per turn. A row is
+ * empty or holds a single item, the same as random generation, so a level can never spawn two
+ * items in one row.
+ *   0x00        end of the level, the stream starts over from its first code
+ *   0x01..0x7F  that many empty rows
+ *   1TTEEXXX    item of type TT at x XXX, followed by EE empty rows
+ * Streams are generated into levels.c by host/level_compile.c from host/levels.txt.
+ */
+enum {
+    kRandomLevel = 0xFF,        // no authored level, items come from the rng
+
+    kLevelEndCode = 0x00,
+    kLevelItemFlag = 0x80,
+    kLevelMaxEmptyRun = 0x7F,
+    kLevelMaxTrailingEmptyRows = 3
+};
+
+extern const uint8_t kLevelCount;
+extern const uint16_t kLevelOffsets[];     // first code of every level in kLevelStreams
+extern const uint8_t kLevelStreams[];
+
+extern void StartLevelStream(const uint8_t *stream);    // stream points at the first code of a level
+extern enum ItemType DecodeLevelRow(uint8_t *x_coordinate);
+
+#endif /* LEVEL_H_ */
@@ -0,0 +1,23 @@
+/*
+ * Authored levels, generated by host/level_compile.c from host/levels.txt. Do not edit.
+ */
+#include <stdint.h>
+
+#include "level.h"
+
+const uint8_t kLevelCount = 3;
+
+const uint16_t kLevelOffsets[] = {0, 22, 50};
+
+const uint8_t kLevelStreams[] = {
+    // 0: Warm up, 69 rows
+    0xB8, 0xB9, 0xBA, 0xC5, 0xBB, 0xBC, 0xC1, 0xBD, 0xBE, 0xBF, 0xC2, 0xBE,
+    0xBC, 0xC7, 0xBA, 0xB8, 0xC4, 0xB9, 0xBB, 0xBD, 0x04, 0x00,
+    // 1: Curtain, 33 rows
+    0xC7, 0xA1, 0xC6, 0xA2, 0xC1, 0xA5, 0xC2, 0xA4, 0xC7, 0xA3, 0xC0, 0xA2,
+    0xC6, 0xA1, 0xC0, 0xB6, 0xC1, 0xA5, 0xC2, 0xA3, 0xC7, 0xA2, 0xC6, 0xA1,
+    0xC5, 0xB8, 0x02, 0x00,
+    // 2: Downpour, 26 rows
+    0xC7, 0xA4, 0xC0, 0xA3, 0xC7, 0xA2, 0xC0, 0xA3, 0xC6, 0xA4, 0xC1, 0xA5,
+    0xC6, 0xA4, 0xC1, 0xA3, 0xC7, 0xA2, 0xC0, 0xB9, 0x03, 0x00
+};
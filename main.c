@@ -4,224 +4,44 @@
 #include "msp430g2553.h"
 
 
+#include "autopilot.h"
+#include "game.h"
 #include "graphics.h"
+#include "level.h"
 #include "rand.h"
 #include "sound.h"
 
 // Constants
-static const uint8_t kTurnsWinThreshold = 100; // number of remaining turns needed to win
-static const uint8_t kMaxItems = 8; // max number of items
-static const uint8_t kCoinReward = 20;  // time reward for coin
-static const uint8_t kBombPenalty = 20;
-static const uint8_t kItemGenerationPeriod = 2;
-static const uint8_t kCoinChance = 4;
 static const uint8_t kTurnDelay = 20;
+static const uint8_t kAttractModeDelay = 3; // spiral loops without input before the autopilot takes over
 
 static const enum Color kPlayerColor = kGreen;
-static const enum Color kBombColor = kRed;
-static const enum Color kCoinColor = kYellow;
 
 
 
-enum ItemType {
-    kUnallocatedItem,
-    kCoin,
-    kBomb
-};
-
-
-enum Button {
-    kNoButton,
-    kLeftButton,
-    kRightButton
-};
-
-struct Item {
-    enum ItemType type;
-    uint8_t x_coordinate;
-    uint8_t y_coordinate;
-}__attribute__((packed));
-
-
-static struct Item items[kMaxItems];
-
-
 static enum Button button_pressed = kNoButton;
 
-static unsigned int player_x_coordinate = 0;                    // starts player at (0,7)
-static int remaining_turns = kTurnsWinThreshold / 2;       // initializes remaining turns to the max
-
-static uint8_t item_generation_delay = 0;
 
 
-
-
-
-static bool IsItemUnallocated(const uint8_t item_index) {
-    return items[item_index].type == kUnallocatedItem;
-}
-
 static enum Color GetItemColor(const uint8_t item_index) {
-    switch (items[item_index].type) {
-        case kBomb: {
-            return kBombColor;
-        }
-
-        case kCoin: {
-            return kCoinColor;
-        }
-
-        default: {
-            return kBlack;
-        }
-    }
-}
-
-
-
-
-static void UpdatePlayerPosition() {
-    /*
-     * Updates player position
-     */
-    switch (button_pressed) {
-        case kLeftButton: {
-            if (player_x_coordinate < kScreenMaxCoordinate) {
-                // If player is not on the right side of the screen
-                ++player_x_coordinate;
-            }
-            break;
-        }
-
-        case kRightButton: {
-            if (player_x_coordinate > 0) {
-                // If player is on the left side of screen
-                --player_x_coordinate;
-            }
-            break;
-        }
-    }
-
-    // Reset button to nothing
-    button_pressed = kNoButton;
-}
-
-
-static int GetFreeItemIndex() {
-    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
-        if (IsItemUnallocated(item_index)) {
-            return item_index;
-        }
-    }
-
-    return -1;
-}
-
-// picks either bomb or coin with a ratio of 8:1
-enum ItemType GenerateRandomItemType() {
-    return rand8() < kCoinChance ? kCoin : kBomb;
-}
-
-static bool CreateRandomItem() {
-    const int item_index = GetFreeItemIndex();
-    if (item_index >= 0) {
-        items[item_index].type = GenerateRandomItemType();
-        items[item_index].x_coordinate = rand8();
-        items[item_index].y_coordinate = 0;
-        return true;
-    }
-
-    return false;
-}
-
-static void HandleItemGeneration() {
-    //generates new item at a set rate
-    if (item_generation_delay >= kItemGenerationPeriod) {
-        CreateRandomItem();
-        item_generation_delay = 0;
-    } else {
-        ++item_generation_delay;
-    }
-}
-
-static bool IsItemOffscreen(const uint8_t item_index) {
-    return items[item_index].y_coordinate > kScreenMaxCoordinate;
-}
-
-static void MoveItemDown(const uint8_t item_index) {
-    items[item_index].y_coordinate += 1;
-}
-
-
-static void RemoveItem(const uint8_t item_index) {
-    items[item_index].type = kUnallocatedItem;
-}
-
-static bool IsItemOverlappingPlayer(const uint8_t item_index) {
-    return items[item_index].y_coordinate == kScreenMaxCoordinate && items[item_index].x_coordinate == player_x_coordinate;
-}
-
-
-static void HandlePlayerCoinCollission() {
-    remaining_turns += kCoinReward;
-}
-
-static void HandlePlayerBombCollission() {
-    remaining_turns -= kBombPenalty;
+    return kItemTypes[GetItem(item_index)->type].color;
 }
 
-static void UpdateItemPosition(const uint8_t item_index) {
-    MoveItemDown(item_index);
-
-    if (IsItemOffscreen(item_index)) {
-        RemoveItem(item_index);
-    } else if (IsItemOverlappingPlayer(item_index)) {
-        switch(items[item_index].type) {
-            case kCoin: {
-                HandlePlayerCoinCollission();
-                break;
-            }
-
-            case kBomb: {
-                HandlePlayerBombCollission();
-                break;
-            }
-        }
-    }
-}
-
-
-static void UpdateItemsPosition() {
-    for (uint8_t item_index = 0; item_index < kMaxItems; ++item_index) {
-        if (!IsItemUnallocated(item_index)) {
-            UpdateItemPosition(item_index);
-        }
-    }
-}
-
-static bool IsGameWon() {
-    return remaining_turns >= kTurnsWinThreshold;
-}
-
-static bool IsGameLost() {
-    return remaining_turns <= 0;
-}
-
-
 
 
 
 static void RenderPlayer() {
-    SetScreenBufferColor(player_x_coordinate, kScreenMaxCoordinate, kPlayerColor);
+    SetScreenBufferColor(GetPlayerXCoordinate(), kScreenMaxCoordinate, kPlayerColor);
 
 }
 
 static void RenderItem(const uint8_t item_index) {
-    SetScreenBufferColor(items[item_index].x_coordinate, items[item_index].y_coordinate, GetItemColor(item_index));
+    const struct Item *item = GetItem(item_index);
+    SetScreenBufferColor(item->x_coordinate, item->y_coordinate, GetItemColor(item_index));
 }
 
 static void DisplayStatus() {
-    SetStatusLedColor(256 * (unsigned int)remaining_turns / kTurnsWinThreshold);
+    SetStatusLedColor(256 * (unsigned int)GetRemainingTurns() / kTurnsWinThreshold);
 }
 
 static void RenderItems() {
@@ -238,21 +58,18 @@ static void RenderGraphics() {
     DisplayStatus();
 }
 
+// the right button plays the authored levels from the first one, the left button a random game
+static void StartNewGame(const enum Button button) {
+    SelectLevel(button == kRightButton ? 0 : kRandomLevel);
+    ResetGameState();
+}
+
 static void sleep(uint8_t count) {
     for (uint8_t i = 0; i < count; ++i) {
         __bis_SR_register(CPUOFF + GIE);
     }
 }
 
-static void ResetGameState() {
-    for (uint8_t i = 0; i < kMaxItems; ++i) {
-        items[i].type = kUnallocatedItem;
-    }
-
-    player_x_coordinate = 0;
-    remaining_turns = kTurnsWinThreshold / 2;
-}
-
 // animation for loss from time
 static void HandleTimeLoss() {
     EraseLedBuffer();
@@ -303,15 +120,50 @@ static void HandleTimeLoss() {
 
 }
 
+// demo game played by the autopilot until a button is pressed
+static void HandleAttractMode() {
+    StopSound();
+    ResetGameState();
+    srand(TA0R);
+
+    while (button_pressed == kNoButton) {
+        EraseLedBuffer();
+
+        if (IsGameLost()) {
+            ResetGameState();
+        }
+        UpdateItemsPosition();
+        HandleItemGeneration();
+        UpdatePlayerPosition(GetAutopilotButton());
+
+        RenderGraphics();
+        SendFrameBuffer();
+
+        // Demo games restart right away instead of playing the end animations
+        if (IsGameWon() || IsGameLost()) {
+            ResetGameState();
+        } else {
+            ConsumeTurn();
+        }
+
+        sleep(kTurnDelay);
+    }
+
+    StartNewGame(button_pressed);
+    button_pressed = kNoButton;
+}
+
 static void StartingAnimation() {
     EraseLedBuffer();
     uint8_t color = 1;
     uint8_t global_counter = 0;
+    uint8_t spiral_count = 0;
 
     const uint8_t dim = kScreenMaxCoordinate + 1;
     while (true) {
         ChooseSong(0);
         if (button_pressed != kNoButton) {
+            StartNewGame(button_pressed);
             button_pressed = kNoButton;
             break;
         }
@@ -374,6 +226,12 @@ static void StartingAnimation() {
         global_counter++;
         if (global_counter >= 65) {
             global_counter = 0;
+
+            // Nobody is playing, let the autopilot show how the game works
+            if (++spiral_count >= kAttractModeDelay) {
+                HandleAttractMode();
+                break;
+            }
         }
         SendFrameBuffer();
         sleep(1);
@@ -392,7 +250,7 @@ static void HandleBombLoss() {
 
         for (uint8_t i = 0; i <= kScreenMaxCoordinate; ++i) {
             for (uint8_t j = 0; j <= kScreenMaxCoordinate; ++j) {
-                if (i == player_x_coordinate || j == kScreenMaxCoordinate) {
+                if (i == GetPlayerXCoordinate() || j == kScreenMaxCoordinate) {
                     SetScreenBufferColor(i, j, kBlack);
                 }
             }
@@ -404,7 +262,7 @@ static void HandleBombLoss() {
         ChooseSong(2);
         for (uint8_t i = 0; i <= kScreenMaxCoordinate; ++i) {
             for (uint8_t j = 0; j <= kScreenMaxCoordinate; ++j) {
-                if (i == player_x_coordinate || j == kScreenMaxCoordinate) {
+                if (i == GetPlayerXCoordinate() || j == kScreenMaxCoordinate) {
                     SetScreenBufferColor(i, j, kRed);
                 }
             }
@@ -425,6 +283,7 @@ static void HandleWin() {
         ChooseSong(1);
         if (button_pressed != kNoButton) {
             button_pressed = kNoButton;
+            AdvanceLevel();
             ResetGameState();
             break;
         }
@@ -452,6 +311,15 @@ static void HandleWin() {
 
 }
 
+// coin and bomb effects play over whatever music is on
+static void PlayCollisionEffect(const int previous_remaining_turns) {
+    if (GetRemainingTurns() > previous_remaining_turns) {
+        PlaySoundEffect(kCoinEffect);
+    } else if (GetRemainingTurns() < previous_remaining_turns) {
+        PlaySoundEffect(kBombEffect);
+    }
+}
+
 static void HandleTurn() {
     EraseLedBuffer();
 
@@ -460,9 +328,14 @@ static void HandleTurn() {
         HandleTimeLoss();
         return;
     }
+    const int remaining_turns = GetRemainingTurns();
     UpdateItemsPosition();
+    PlayCollisionEffect(remaining_turns);
     HandleItemGeneration();
-    UpdatePlayerPosition();
+    UpdatePlayerPosition(button_pressed);
+
+    // Reset button to nothing
+    button_pressed = kNoButton;
 
 
     RenderGraphics();
@@ -475,7 +348,7 @@ static void HandleTurn() {
         HandleBombLoss();
     }
 
-    --remaining_turns;
+    ConsumeTurn();
 }
 
 
@@ -487,24 +360,8 @@ int main() {
     DCOCTL = CALDCO_1MHZ;       // load calibration data
     BCSCTL3 |= LFXT1S_2;        // ACLK source from VLO
 
-    // Buzzer output pins
-    P2DIR |= BIT1 + BIT5;       // P2.1 & P2.5 output pins for buzzer
-    P2OUT &= ~BIT5;             // P2.5 ground pin for buzzer
-    P2SEL |= BIT1;              // P2.1 buzzer PWM for TA1.1
-
     InitializeGraphics();                //SPI and led port setup
-
-    // TimerA1.1 PWM setup
-    TA1CCTL1 = OUTMOD_7; // Output is high until the counter reaches the value of CCR1
-    TA1CTL = TASSEL_2 + MC_1;     // source from SMCLK, upmode
-    TA1CCR0 = 0;                  // PWM period to init value
-    TA1CCR1 = 0;                  // Duty cycle 0%
-
-    // TimerA0 Setup. Use CLK as source of noise for rng seed
-    TA0CCR0 = 60000;                 // TA0 PWM period
-    TA0CCR1 = 0;                   // TA0CCR1 PWM duty cycle
-    TA0CCTL1 |= OUTMOD_7;          // TA0CCR1 set output mode to reset/set
-    TA0CTL |= TASSEL_2 + MC_1; // Source TA0 from SMCLK, set to Up Mode (Counts to TA0CCR0, reset
+    InitializeSound();                   //Buzzer PWM and mixer timers, TA0 is also the rng seed source
 
     // Watchdog timer init
     WDTCTL = WDT_MDLY_8;        // Enter WDT ISR every 8ms
@@ -531,14 +388,18 @@ int main() {
 
 
 // WDT ISR
+#ifndef HOST_BUILD
 #pragma vector=WDT_VECTOR
+#endif
 __interrupt void watchdog_timer(void)
 {
     __bic_SR_register_on_exit(CPUOFF + GIE); //Upon wdt interrupt, return to main while loop.
 }
 
 // Port2 ISR - button press detection
+#ifndef HOST_BUILD
 #pragma vector=PORT2_VECTOR
+#endif
 __interrupt void port_2(void)
 {
     //P2IE &= ~P2IE;       // P2.0 interrupt disabled to avoid bouncing effect
@@ -552,6 +413,8 @@ __interrupt void port_2(void)
 #if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
 #pragma vector=USCIAB0TX_VECTOR
 __interrupt void USCIB0TX_ISR(void)
+#elif defined(HOST_BUILD)
+void USCIB0TX_ISR(void)
 #elif defined(__GNUC__)
 void __attribute__ ((interrupt(USCIAB0RX_VECTOR))) USCIB0RX_ISR (void)
 #else
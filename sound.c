@@ -2,6 +2,56 @@
 
 #include "msp430g2553.h"
 
+#include "sound.h"
+
+/*
+ * Two voice mixer. TA1 runs a PWM carrier above hearing on the TA1.1 buzzer pin, and a TA0 CCR1
+ * interrupt at SAMPLE_RATE advances one phase accumulator per voice and writes the summed square
+ * waves into the TA1.1 duty cycle. Voice 0 plays the songs, voice 1 the effects, so effects play
+ * over music. The interrupt is only enabled while a voice is sounding.
+ *
+ * Worst case mixer ISR, counted by hand from MSP430 instruction timings (see cycles.h) for the
+ * optimized (Release) build, effect note change included:
+ *   interrupt entry 6, save R12-R15 12, TA0IV dispatch 6, CCR1 reschedule 5, 2 voices x 14,
+ *   effect countdown 8, next effect note 18, duty write 4, silence check 6, restore R12-R15 8,
+ *   reti 5 = ~106 cycles
+ * The cycle count does not depend on the clock, the sample period does:
+ *   1 MHz:  SAMPLE_PERIOD 250,  PWM_PERIOD 32   -> 42% of the CPU while a voice plays
+ *   16 MHz: SAMPLE_PERIOD 4000, PWM_PERIOD 512  -> 2.7% of the CPU while a voice plays
+ * The firmware runs at 1 MHz, and the songs play for the whole start spiral, win screen and lose
+ * screen, so every frame there takes about 1 / 0.58 = 1.7 times as long as it does in silence
+ * (a ~16300 cycle frame becomes ~28000). In a game only the short coin and bomb effects play.
+ * The ISR never nests, so the USCI TX interrupt SendFrameBuffer waits on is delayed by at most
+ * one mixer ISR (~3 SPI bytes at 1 MHz) and never starved.
+ *
+ * This is a hand count only. SOUND_PROFILE_ISR has not been run on a board yet, so no measured
+ * figure exists to check it against. Define it to get one: the ISR reads TA0R (SMCLK, so one
+ * count per CPU cycle) as its first and last statement and keeps the largest difference in
+ * sound_isr_max_cycles, for the mixing path and the early return alike. The reads sit inside
+ * the compiled function, so the result leaves out the interrupt entry, reti and the register
+ * save and restore the compiler emits around the body (6 + 5 + 3 per push + 2 per pop, 31 for
+ * four registers; check the pushes in the listing file) and includes one TA0R read.
+ *
+ * SMCLK_FREQUENCY is the one clock setting the mixer derives its timer periods from, so
+ * -DSMCLK_FREQUENCY=16000000UL builds the 16 MHz mixer. main() would also have to load
+ * CALBC1_16MHZ, and its watchdog turn timing and SPI divider assume 1 MHz as well.
+ */
+#ifndef SMCLK_FREQUENCY
+#define SMCLK_FREQUENCY 1000000UL   // matches the 1 MHz DCO calibration in main()
+#endif
+#define SAMPLE_RATE 4000UL
+#define SAMPLE_PERIOD (SMCLK_FREQUENCY / SAMPLE_RATE)   // TA0 cycles between mixer interrupts
+#define PWM_FREQUENCY 31250UL                           // carrier above hearing
+#define PWM_PERIOD (SMCLK_FREQUENCY / PWM_FREQUENCY)    // TA1 cycles per carrier period, the duty steps
+#define VOICE_LEVEL ((PWM_PERIOD - 1) / 2)              // duty of one voice in its high half period
+
+// Phase increment of a square wave, frequencies must stay below SAMPLE_RATE / 2
+#define NOTE(frequency) ((uint16_t)(((frequency) * 65536UL) / SAMPLE_RATE))
+#define SILENCE 0
+
+// Length of an effect note
+#define MILLISECONDS(duration) ((uint16_t)((duration) * SAMPLE_RATE / 1000))
+
 #define l1 261 // low C
 #define l2 294 // low D
 #define l3 329 // low E
@@ -21,37 +71,109 @@
 #define m5 784 // mid G
 #define m5s 830 // mid G#
 #define m6 880 // mid A
-#define h69 10000
-#define h70 5000
-#define h50 3000
+#define h69 1900 // squeaks, were 10/5/3 kHz before the mixer and are now the top of its range
+#define h70 1700
+#define h50 1500
+
+
+struct EffectNote {
+    uint16_t phase_increment;
+    uint16_t samples;
+};
 
+static const uint16_t start_song[] = {NOTE(m1), NOTE(m6), NOTE(m1), NOTE(m6), NOTE(m4), NOTE(m3), NOTE(m2), NOTE(m1)};
+static const uint16_t win_song[] = {NOTE(h69), NOTE(m6), NOTE(m1), NOTE(h50), NOTE(m4), NOTE(h70), NOTE(m4), NOTE(m6)};
+static const uint16_t lose_song[] = {NOTE(m2), NOTE(m1), NOTE(l6s), NOTE(l6), NOTE(l5), NOTE(l4), NOTE(14), NOTE(14)};
 
-static const unsigned int start_song[] = {m1, m6, m1, m6, m4, m3, m2, m1};
-static const int win_song[] = {h69, m6, m1, h50, m4, h70, m4, m6};
-static const int lose_song[] = {m2, m1, l6s, l6, l5, l4, 14, 14};
+static const struct EffectNote coin_effect[] = {
+    {NOTE(m5), MILLISECONDS(40)}, {NOTE(m1 * 2), MILLISECONDS(80)}
+};
+static const struct EffectNote bomb_effect[] = {
+    {NOTE(l3), MILLISECONDS(60)}, {NOTE(l1 / 2), MILLISECONDS(120)}
+};
+
+enum {
+    kMusicVoice,
+    kEffectVoice,
+    kVoiceCount
+};
+
+static volatile uint16_t voice_phases[kVoiceCount];
+static volatile uint16_t voice_increments[kVoiceCount];
+
+static const struct EffectNote *volatile effect_note;
+static volatile uint16_t effect_samples_left;
+static volatile uint8_t effect_notes_left;
+
+#ifdef SOUND_PROFILE_ISR
+volatile uint16_t sound_isr_max_cycles = 0;
+#endif
 
 static uint8_t count1 = 0;
 static uint8_t i = 0;
 
-static void PlaySong(unsigned int *note_string, uint8_t notes_length, uint8_t tempo) {
+
+// Starts the mixer interrupt if it is not running, called with the new voice already set
+static void StartMixer() {
+    if (!(TA0CCTL1 & CCIE)) {
+        TA0CCR1 = TA0R + SAMPLE_PERIOD;
+        TA0CCTL1 = CCIE;
+    }
+}
+
+static void SetMusicNote(const uint16_t phase_increment) {
+    voice_increments[kMusicVoice] = phase_increment;
+    if (phase_increment != SILENCE) {
+        StartMixer();
+    }
+}
+
+static void PlaySong(const uint16_t *note_string, uint8_t notes_length, uint8_t tempo) {
     if (count1 == tempo) {
         count1 = 0;
-        TA1CCR0 = 1000000 / note_string[i]; // This determines note frequency, PWM period
-        TA1CCR1 = TA1CCR0 / 2;              // Switch buzzer off for part of the period
+        SetMusicNote(note_string[i]); // This determines note frequency
         i++;
         if(i == notes_length){
             i = 0;
         }
     } else if (count1 == tempo - 1) {
-        TA1CCR0 = 0;    // Stop tone for a little bit
-        TA1CCR1 = 0;
+        SetMusicNote(SILENCE);    // Stop tone for a little bit
     }
     count1++;
 
 }
 
+static void PlayEffect(const struct EffectNote *notes, const uint8_t notes_length) {
+    TA0CCTL1 &= ~CCIE;      // The mixer steps effects, keep it out while they are replaced
+
+    effect_note = notes;
+    effect_notes_left = notes_length;
+    effect_samples_left = notes[0].samples;
+    voice_increments[kEffectVoice] = notes[0].phase_increment;
+
+    TA0CCR1 = TA0R + SAMPLE_PERIOD;
+    TA0CCTL1 = CCIE;
+}
+
+extern void InitializeSound() {
+    // Buzzer output pins
+    P2DIR |= BIT1 + BIT5;       // P2.1 & P2.5 output pins for buzzer
+    P2OUT &= ~BIT5;             // P2.5 ground pin for buzzer
+    P2SEL |= BIT1;              // P2.1 buzzer PWM for TA1.1
+
+    // TimerA1.1 PWM carrier
+    TA1CCTL1 = OUTMOD_7;          // Output is high until the counter reaches the value of CCR1
+    TA1CCR0 = PWM_PERIOD - 1;     // PWM period
+    TA1CCR1 = 0;                  // Duty cycle 0%
+    TA1CTL = TASSEL_2 + MC_1;     // source from SMCLK, upmode
+
+    // TimerA0 free runs from SMCLK, CCR1 schedules the mixer and TA0R seeds the rng
+    TA0CCTL1 = 0;
+    TA0CTL = TASSEL_2 + MC_2;     // source from SMCLK, continuous mode
+}
+
 extern void StopSound() {
-    TA1CCR1 = 0;    // Turn off the buzzer
+    voice_increments[kMusicVoice] = SILENCE;    // Turn off the music, effects play out
     count1 = 0;
     i = 0;
 }
@@ -71,3 +193,65 @@ extern void ChooseSong(uint8_t song_num) {
     }
 }
 
+extern void PlaySoundEffect(enum SoundEffect effect) {
+    switch (effect)
+    {
+    case kCoinEffect:
+        PlayEffect(coin_effect, sizeof(coin_effect) / sizeof(coin_effect[0]));
+        break;
+    case kBombEffect:
+        PlayEffect(bomb_effect, sizeof(bomb_effect) / sizeof(bomb_effect[0]));
+        break;
+    }
+}
+
+
+// Mixer, see the cycle budget at the top of the file
+#ifndef HOST_BUILD
+#pragma vector=TIMER0_A1_VECTOR
+#endif
+__interrupt void sound_mixer(void)
+{
+#ifdef SOUND_PROFILE_ISR
+    const uint16_t start = TA0R;
+#endif
+    // A single exit, so the profile covers the early return as well
+    if (TA0IV == TA0IV_TACCR1) {
+        TA0CCR1 += SAMPLE_PERIOD;
+
+        uint16_t duty = 0;
+        voice_phases[kMusicVoice] += voice_increments[kMusicVoice];
+        if (voice_phases[kMusicVoice] & 0x8000) {
+            duty += VOICE_LEVEL;
+        }
+        voice_phases[kEffectVoice] += voice_increments[kEffectVoice];
+        if (voice_phases[kEffectVoice] & 0x8000) {
+            duty += VOICE_LEVEL;
+        }
+
+        if (effect_notes_left != 0 && --effect_samples_left == 0) {
+            if (--effect_notes_left == 0) {
+                voice_increments[kEffectVoice] = SILENCE;
+            } else {
+                ++effect_note;
+                effect_samples_left = effect_note->samples;
+                voice_increments[kEffectVoice] = effect_note->phase_increment;
+            }
+        }
+
+        TA1CCR1 = duty;
+
+        // Nothing left to play, stop interrupting until a voice starts again
+        if (voice_increments[kMusicVoice] == SILENCE && voice_increments[kEffectVoice] == SILENCE) {
+            TA0CCTL1 = 0;
+            TA1CCR1 = 0;
+        }
+    }
+
+#ifdef SOUND_PROFILE_ISR
+    const uint16_t cycles = TA0R - start;
+    if (cycles > sound_isr_max_cycles) {
+        sound_isr_max_cycles = cycles;
+    }
+#endif
+}
@@ -3,7 +3,14 @@
 
 #include <stdint.h>
 
+enum SoundEffect {
+    kCoinEffect,
+    kBombEffect
+};
+
+extern void InitializeSound();
 extern void ChooseSong(uint8_t song_num);
 extern void StopSound();
+extern void PlaySoundEffect(enum SoundEffect effect);
 
 #endif /* SOUND_H_ */